@@ -0,0 +1,172 @@
+#ifndef BACKGROUNDWORK_H
+#define BACKGROUNDWORK_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CppDiFactory
+{
+    /// Keeps track of background tasks working on an object (e.g. the DiFactory).
+    /// Tasks may still be queued on an executor when the object is destroyed. Such
+    /// tasks hold a shared_ptr to the guard and call enter() before touching the
+    /// object; enter() fails once stop() or shutdown() has been called. shutdown()
+    /// waits until all tasks which entered successfully have left again.
+    class TaskGuard
+    {
+    public:
+        TaskGuard(): _stopped(false), _running(0) {}
+
+        bool enter()
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+            if (_stopped){
+                return false;
+            }
+            ++_running;
+            return true;
+        }
+
+        void leave()
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+            if (--_running == 0){
+                _idle.notify_all();
+            }
+        }
+
+        /// Let enter() fail from now on (tasks which already entered keep running).
+        void stop()
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+            _stopped = true;
+        }
+
+        void shutdown()
+        {
+            std::unique_lock<std::mutex> lock{ _mutex };
+            _stopped = true;
+            _idle.wait(lock, [this]() { return _running == 0; });
+        }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _idle;
+        bool _stopped;
+        size_t _running;
+    };
+
+    /// Runs tasks periodically on a single background thread.
+    /// The thread is started with the first task.
+    class PeriodicScheduler
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        PeriodicScheduler(): _stopped(false) {}
+
+        ~PeriodicScheduler()
+        {
+            stop();
+        }
+
+        PeriodicScheduler(const PeriodicScheduler&) = delete;
+        PeriodicScheduler& operator=(const PeriodicScheduler&) = delete;
+
+        /// Run task every interval (first run after one interval).
+        /// A task previously scheduled with the same key is replaced.
+        void schedule(size_t key, clock::duration interval, std::function<void()> task)
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            Entry entry{ key, interval, clock::now() + interval, task };
+            bool replaced = false;
+            for (Entry& existing : _entries){
+                if (existing.key == key){
+                    existing = entry;
+                    replaced = true;
+                }
+            }
+            if (!replaced){
+                _entries.push_back(entry);
+            }
+
+            if (!_thread.joinable() && !_stopped){
+                _thread = std::thread([this]() { run(); });
+            }
+            _wakeUp.notify_one();
+        }
+
+        /// Remove the task scheduled with key (a running task is not interrupted).
+        void cancel(size_t key)
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            for (auto it = _entries.begin(); it != _entries.end(); ++it){
+                if (it->key == key){
+                    _entries.erase(it);
+                    break;
+                }
+            }
+        }
+
+        /// Stop the background thread (waits for a running task to finish).
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lockGuard{ _mutex };
+                _stopped = true;
+            }
+            _wakeUp.notify_one();
+            if (_thread.joinable()){
+                _thread.join();
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            size_t key;
+            clock::duration interval;
+            clock::time_point next;
+            std::function<void()> task;
+        };
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock{ _mutex };
+            while (!_stopped){
+                Entry* due = nullptr;
+                for (Entry& entry : _entries){
+                    if (!due || entry.next < due->next){
+                        due = &entry;
+                    }
+                }
+
+                if (!due){
+                    _wakeUp.wait(lock);
+                } else if (due->next > clock::now()){
+                    _wakeUp.wait_until(lock, due->next);
+                } else {
+                    due->next = clock::now() + due->interval;
+                    std::function<void()> task = due->task;
+                    lock.unlock();
+                    task();
+                    lock.lock();
+                }
+            }
+        }
+
+        std::mutex _mutex;
+        std::condition_variable _wakeUp;
+        std::vector<Entry> _entries;
+        bool _stopped;
+        std::thread _thread;
+    };
+} // namespace CppDiFactory
+
+#endif // BACKGROUNDWORK_H
@@ -0,0 +1,131 @@
+#ifndef CALLSITESTATISTICS_H
+#define CALLSITESTATISTICS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CppDiFactory
+{
+    /// Call site (or user supplied tag) of a request.
+    /// Use CPPDIFACTORY_CALL_SITE to get the call site of the current line
+    /// (file and function are string literals, the tag is copied).
+    struct CallSite
+    {
+        explicit CallSite(const std::string& tag): file(""), line(0), function(""), tag(tag) {}
+        CallSite(const char* file, int line, const char* function): file(file), line(line), function(function) {}
+
+        const char* file;
+        int line;
+        const char* function;
+        std::string tag;
+    };
+
+    /// Aggregated requests of a call site.
+    struct CallSiteStatistics
+    {
+        std::string file;
+        int line;
+        std::string function;
+        std::string tag;
+        size_t count;
+        std::chrono::nanoseconds totalTime;
+    };
+
+    /// Aggregates number and duration of requests per call site.
+    class CallSiteRecorder
+    {
+    public:
+        CallSiteRecorder(): _enabled(false) {}
+
+        void enable(bool enable)
+        {
+            _enabled.store(enable, std::memory_order_relaxed);
+        }
+
+        bool enabled() const
+        {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        void record(const CallSite& callSite, std::chrono::nanoseconds duration)
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            Entry& entry = _entries[Key{ callSite.file, callSite.line, callSite.tag }];
+            if (entry.count == 0){
+                entry.function = callSite.function;
+            }
+            ++entry.count;
+            entry.totalTime += duration;
+        }
+
+        /// Statistics of all call sites, most expensive call sites first.
+        std::vector<CallSiteStatistics> statistics() const
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            std::vector<CallSiteStatistics> result;
+            for (const auto& it : _entries){
+                result.push_back(CallSiteStatistics{ it.first.file, it.first.line, it.second.function, it.first.tag,
+                                                     it.second.count, it.second.totalTime });
+            }
+            std::sort(result.begin(), result.end(), [](const CallSiteStatistics& a, const CallSiteStatistics& b) {
+                return a.totalTime > b.totalTime;
+            });
+            return result;
+        }
+
+        void reset()
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+            _entries.clear();
+        }
+
+    private:
+        /// by value, so equal call sites of different translation units share their entry
+        struct Key
+        {
+            std::string file;
+            int line;
+            std::string tag;
+
+            bool operator==(const Key& other) const
+            {
+                return file == other.file && line == other.line && tag == other.tag;
+            }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const
+            {
+                return std::hash<std::string>()(key.file) ^ (static_cast<size_t>(key.line) * 31) ^ std::hash<std::string>()(key.tag);
+            }
+        };
+
+        struct Entry
+        {
+            Entry(): count(0), totalTime(0) {}
+
+            std::string function;
+            size_t count;
+            std::chrono::nanoseconds totalTime;
+        };
+
+        std::atomic<bool> _enabled;
+        mutable std::mutex _mutex;
+        std::unordered_map<Key, Entry, KeyHash> _entries;
+    };
+} // namespace CppDiFactory
+
+/// Call site of the current line (for DiFactory::getInstance).
+#define CPPDIFACTORY_CALL_SITE ::CppDiFactory::CallSite(__FILE__, __LINE__, __func__)
+
+#endif // CALLSITESTATISTICS_H
@@ -0,0 +1,172 @@
+#ifndef COMPOSITE_H
+#define COMPOSITE_H
+
+#include <type_traits>
+
+namespace CppDiFactory
+{
+    /// Description of one member of a Composite.
+    /// \tparam Class  Type of the member
+    /// \tparam Dependencies  Types of the constructor parameters of Class. The constructor
+    ///         gets references (Dependencies&...) to earlier members of the composite.
+    ///         A dependency may also be a base class (interface) of an earlier member.
+    template <typename Class, typename... Dependencies>
+    struct Component {};
+
+    namespace CompositeDetail
+    {
+        template <bool... Values>
+        struct BoolList {};
+
+        template <bool... Values>
+        struct All: std::is_same<BoolList<true, Values...>, BoolList<Values..., true> > {};
+
+        /// Check if a member of type Class can be used for a dependency of type T.
+        template <typename Class, typename T>
+        struct Provides: std::integral_constant<bool, std::is_same<Class, T>::value || std::is_base_of<T, Class>::value> {};
+
+        template <typename T, typename... Classes>
+        struct AnyProvides: std::false_type {};
+
+        template <typename T, typename Class, typename... Classes>
+        struct AnyProvides<T, Class, Classes...>: std::integral_constant<bool, Provides<Class, T>::value || AnyProvides<T, Classes...>::value> {};
+
+        template <typename T, typename... Classes>
+        struct AnySame: std::false_type {};
+
+        template <typename T, typename Class, typename... Classes>
+        struct AnySame<T, Class, Classes...>: std::integral_constant<bool, std::is_same<Class, T>::value || AnySame<T, Classes...>::value> {};
+
+        template <typename... Classes>
+        struct Seen {};
+
+        /// Check that every member only depends on earlier members and that
+        /// no type is used for more than one member.
+        template <typename SeenClasses, typename... Components>
+        struct WellOrdered: std::true_type {};
+
+        template <typename... SeenClasses, typename Class, typename... Dependencies, typename... Components>
+        struct WellOrdered<Seen<SeenClasses...>, Component<Class, Dependencies...>, Components...>:
+            std::integral_constant<bool,
+                All<AnyProvides<Dependencies, SeenClasses...>::value...>::value &&
+                !AnySame<Class, SeenClasses...>::value &&
+                WellOrdered<Seen<SeenClasses..., Class>, Components...>::value> {};
+
+        /// First component providing T (exact type preferred over base classes).
+        template <typename T, bool Exact, typename... Components>
+        struct FindProvider;
+
+        template <typename T, bool Exact, typename Class, typename... Dependencies, typename... Components>
+        struct FindProvider<T, Exact, Component<Class, Dependencies...>, Components...>:
+            std::conditional<Exact ? std::is_same<Class, T>::value : Provides<Class, T>::value,
+                             Component<Class, Dependencies...>,
+                             typename FindProvider<T, Exact, Components...>::type> {};
+
+        template <typename T, bool Exact>
+        struct FindProvider<T, Exact>
+        {
+            using type = void;
+        };
+
+        template <typename T, typename... Components>
+        struct ProviderOf
+        {
+            using exact = typename FindProvider<T, true, Components...>::type;
+            using type  = typename std::conditional<std::is_void<exact>::value,
+                                                    typename FindProvider<T, false, Components...>::type,
+                                                    exact>::type;
+        };
+
+        template <typename... Components>
+        struct Last;
+
+        template <typename C>
+        struct Last<C>
+        {
+            using type = C;
+        };
+
+        template <typename C, typename... Components>
+        struct Last<C, Components...>: Last<Components...> {};
+
+        template <typename C>
+        struct ClassOf;
+
+        template <typename Class, typename... Dependencies>
+        struct ClassOf<Component<Class, Dependencies...> >
+        {
+            using type = Class;
+        };
+
+        /// Storage of one member (a base class of the composite).
+        template <typename C>
+        class Member;
+
+        template <typename Class, typename... Dependencies>
+        class Member<Component<Class, Dependencies...> >
+        {
+        public:
+            template <typename Owner>
+            explicit Member(Owner& owner): _instance(owner.template get<Dependencies>()...) {}
+
+            Class _instance;
+        };
+    } // namespace CompositeDetail
+
+    /// Object graph of a fixed shape stored in a single object.
+    /// All members are direct (by-value) members of the composite, constructed in the
+    /// order of the components and wired by references. Creating a composite is one
+    /// constructor call without any heap allocation (besides the ones done by the
+    /// members themselves). The last component is the root of the graph.
+    /// \code
+    ///   using Pipeline = Composite<Component<Decoder>,
+    ///                              Component<Filter, Decoder>,
+    ///                              Component<Router, IFilter, Decoder>>;
+    ///   Pipeline pipeline;                // or diFactory.registerComposite<Pipeline>()
+    ///   Router& router = pipeline.root();
+    /// \endcode
+    /// A composite can not be copied or moved, as its members refer to each other.
+    template <typename... Components>
+    class Composite: private CompositeDetail::Member<Components>...
+    {
+        static_assert(sizeof...(Components) > 0, "Composite without components");
+        static_assert(CompositeDetail::WellOrdered<CompositeDetail::Seen<>, Components...>::value,
+                      "Composite members must only depend on earlier members and each type may only be used once");
+
+    public:
+        using root_type = typename CompositeDetail::ClassOf<typename CompositeDetail::Last<Components...>::type>::type;
+
+        Composite(): CompositeDetail::Member<Components>(*this)... {}
+
+        Composite(const Composite&) = delete;
+        Composite& operator=(const Composite&) = delete;
+
+        /// Get the member of type T (or the first member implementing T).
+        template <typename T>
+        T& get()
+        {
+            using Provider = typename CompositeDetail::ProviderOf<T, Components...>::type;
+            static_assert(!std::is_void<Provider>::value, "No member of the composite provides this type");
+
+            return static_cast<CompositeDetail::Member<Provider>&>(*this)._instance;
+        }
+
+        template <typename T>
+        const T& get() const
+        {
+            return const_cast<Composite*>(this)->get<T>();
+        }
+
+        root_type& root()
+        {
+            return get<root_type>();
+        }
+
+        const root_type& root() const
+        {
+            return get<root_type>();
+        }
+    };
+} // namespace CppDiFactory
+
+#endif // COMPOSITE_H
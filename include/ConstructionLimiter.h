@@ -0,0 +1,88 @@
+#ifndef CONSTRUCTIONLIMITER_H
+#define CONSTRUCTIONLIMITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace CppDiFactory
+{
+    /// Limits the number of simultaneous constructions of a type.
+    /// Threads waiting for a construction slot are served in FIFO order.
+    class ConstructionLimiter
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /// \param maxConcurrent  maximum number of simultaneous constructions
+        /// \param timeout        maximum time to wait for a slot (zero: wait forever)
+        ConstructionLimiter(size_t maxConcurrent, clock::duration timeout = clock::duration::zero()):
+            _maxConcurrent(maxConcurrent), _timeout(timeout), _active(0)
+        {}
+
+        ConstructionLimiter(const ConstructionLimiter&) = delete;
+        ConstructionLimiter& operator=(const ConstructionLimiter&) = delete;
+
+        /// Wait for a free slot.
+        /// \return false if the timeout expired
+        bool acquire()
+        {
+            std::unique_lock<std::mutex> lock{ _mutex };
+
+            if (_active < _maxConcurrent && _waiting.empty()){
+                ++_active;
+                return true;
+            }
+
+            bool granted = false;
+            _waiting.push_back(&granted);
+
+            if (_timeout == clock::duration::zero()){
+                _released.wait(lock, [&granted]() { return granted; });
+                return true;
+            }
+
+            if (!_released.wait_for(lock, _timeout, [&granted]() { return granted; })){
+                for (auto it = _waiting.begin(); it != _waiting.end(); ++it){
+                    if (*it == &granted){
+                        _waiting.erase(it);
+                        break;
+                    }
+                }
+                return false;
+            }
+            return true;
+        }
+
+        /// Release a slot (it is handed over to the longest waiting thread).
+        void release()
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            if (_waiting.empty()){
+                --_active;
+            } else {
+                *_waiting.front() = true;
+                _waiting.pop_front();
+                _released.notify_all();
+            }
+        }
+
+        size_t maxConcurrent() const
+        {
+            return _maxConcurrent;
+        }
+
+    private:
+        const size_t _maxConcurrent;
+        const clock::duration _timeout;
+        size_t _active;
+        std::deque<bool*> _waiting;
+        std::mutex _mutex;
+        std::condition_variable _released;
+    };
+} // namespace CppDiFactory
+
+#endif // CONSTRUCTIONLIMITER_H
@@ -10,10 +10,43 @@
 #ifndef CPP_DI_FACTORY_H
 #define CPP_DI_FACTORY_H
 
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_set>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+#include "BackgroundWork.h"
+#include "CallSiteStatistics.h"
+#include "Composite.h"
+#include "ConstructionLimiter.h"
+#include "Executor.h"
 #include "FakeMutex.h"
+#include "FlatCombining.h"
+#include "FrozenRegistry.h"
+#include "Interceptor.h"
+#include "LifetimeAdvisor.h"
+#include "Lifetimes.h"
+#include "LongLivedRegion.h"
+#include "MappedImage.h"
+#include "MemoryPressureWatcher.h"
+#include "NumaTopology.h"
+#include "Probes.h"
+#include "ReachabilityIndex.h"
+#include "RequestScope.h"
+#include "StartupAnalysis.h"
+#include "TypeName.h"
+#include "UsageProfile.h"
+#include "ValidationCache.h"
+#include "WorkStealingExecutor.h"
 
 /// C++ Dependency Injection Factory
 /// Dependency injection container aka Inversion of Control (IoC) container
@@ -24,6 +57,7 @@
 /// https://github.com/Autodesk/goatnative-inject.git
 namespace CppDiFactory
 {
+    using std::allocate_shared;
     using std::lock_guard;
     using std::make_shared;
     using std::mutex;
@@ -49,6 +83,36 @@ namespace CppDiFactory
     template<typename T>
     size_t type_id() { return reinterpret_cast<size_t>(&type<T>::id); }
 
+    /// Marker for a dependency which is exclusively owned by the class depending on it:
+    /// the constructor gets a new instance as std::unique_ptr<T> instead of a shared_ptr
+    /// (no control block and no reference counting).
+    /// Only types registered with registerClass (or interfaces implemented by such
+    /// classes) can be exclusively owned, which is checked by the validation.
+    /// \code
+    ///   Handler(std::unique_ptr<IParser> parser);
+    ///
+    ///   diFactory.registerClass<Handler, CppDiFactory::Unique<IParser> >();
+    /// \endcode
+    template <typename T>
+    struct Unique {};
+
+    /// Registered type and parameter type of a dependency.
+    template <typename T>
+    struct DependencyType
+    {
+        using type = T;
+        using pointer = std::shared_ptr<T>;
+        static const bool unique = false;
+    };
+
+    template <typename T>
+    struct DependencyType<Unique<T> >
+    {
+        using type = T;
+        using pointer = std::unique_ptr<T>;
+        static const bool unique = true;
+    };
+
     /// The DiFactory is an object factory implementing the dependency injection pattern.
     /// All instances are managed using std::shared_ptr.
     /// The DiFactory allows to register different classes and the interfaces they implement.
@@ -157,27 +221,121 @@ namespace CppDiFactory
     ///
     class DiFactory
     {
-#if defined(MULTITHREADED)
+#if defined(MULTITHREADED) && defined(CPPDIFACTORY_FLAT_COMBINING) && defined(CPPDIFACTORY_USDT)
+        using mutex_type = FlatCombiningMutex<ProbedMutex<mutex> >;
+#elif defined(MULTITHREADED) && defined(CPPDIFACTORY_FLAT_COMBINING)
+        using mutex_type = FlatCombiningMutex<mutex>;
+#elif defined(MULTITHREADED) && defined(CPPDIFACTORY_USDT)
+        using mutex_type = ProbedMutex<mutex>;
+#elif defined(MULTITHREADED)
         using mutex_type = mutex;
 #else
         using mutex_type = FakeMutex;
 #endif
+        class AbstractRegistration;
+
     public:
+        DiFactory() = default;
+
+        ~DiFactory()
+        {
+            _memoryPressureWatcher.stop();
+            _scheduler.stop();
+            _backgroundTasks->shutdown();
+        }
+
         /// A helper object which allows to register one or more interfaces
-        /// for a specific type.
+        /// for a specific type and to configure the registration.
         /// This object is returned by the various registerXY methods
         /// of the DiFactory.
         template <typename T>
         class InterfaceForType
         {
         public:
-            InterfaceForType(DiFactory& diFactory): _diFactory(diFactory) {}
+            InterfaceForType(DiFactory& diFactory, shared_ptr<AbstractRegistration> registration):
+                _diFactory(diFactory), _registration(registration) {}
 
             /// Register the supplied interface types for this object.
             template <typename... I>
-            void withInterfaces()
+            InterfaceForType& withInterfaces()
             {
                 this->withInterfacesImpl<I...>(NumberToType<sizeof...(I)>());
+                return *this;
+            }
+
+            /// Construct the instances of this type on the supplied executor.
+            /// The dependencies are resolved on the requesting thread, only the
+            /// constructor itself is run on the executor. The requesting thread
+            /// waits until the instance has been created (see getInstanceAsync
+            /// for a non-blocking alternative).
+            /// \note The constructor must not use the DiFactory, and the executor
+            ///       must not wait for the DiFactory while constructing (so it
+            ///       must not be the executor of the factory, see setExecutor).
+            InterfaceForType& constructOn(shared_ptr<Executor> executor)
+            {
+                lock_guard<mutex_type> lockGuard{ _diFactory._mutex };
+
+                _registration->setConstructionExecutor(executor);
+                _diFactory._constructionExecutors = true;
+                return *this;
+            }
+
+            /// Limit the number of instances of this type which are constructed
+            /// simultaneously without the factory being locked (refresh, warmUp and
+            /// rebuildAffected, possibly on different threads and executors). Further
+            /// constructions wait (in FIFO order) until a construction finished.
+            /// Requests construct their instances with the factory locked, one at a
+            /// time, and therefore never wait for the limit.
+            /// \param maxConcurrent  maximum number of simultaneous constructions (at least 1)
+            /// \param timeout  maximum time to wait (zero: no timeout). If the timeout
+            ///                 expires, an exception is thrown.
+            InterfaceForType& maxConcurrentConstructions(size_t maxConcurrent,
+                                                         std::chrono::steady_clock::duration timeout = std::chrono::steady_clock::duration::zero())
+            {
+                if (maxConcurrent == 0){
+                    throw new std::logic_error("At least one construction must be allowed");
+                }
+                lock_guard<mutex_type> lockGuard{ _diFactory._mutex };
+
+                _registration->setConstructionLimiter(make_shared<ConstructionLimiter>(maxConcurrent, timeout));
+                return *this;
+            }
+
+            /// Keep a copy of a registered instance (registerInstance) on each
+            /// NUMA node. The copies are created by the copy constructor on a
+            /// thread bound to the node, so the copy constructor should copy
+            /// all data (deep copy). Requests get the copy of the node they are
+            /// running on.
+            /// Only use this for instances which are not modified.
+            InterfaceForType& replicatePerNumaNode()
+            {
+                lock_guard<mutex_type> lockGuard{ _diFactory._mutex };
+
+                _registration->replicatePerNumaNode();
+                _diFactory._threadDependentRequests = true;
+                return *this;
+            }
+
+            /// Keep the instance of a singleton alive even if it is not used any
+            /// longer, so it is not rebuilt for the next request. Retained instances
+            /// are released under memory pressure (see evictAt).
+            InterfaceForType& retain()
+            {
+                lock_guard<mutex_type> lockGuard{ _diFactory._mutex };
+
+                _registration->retain();
+                return *this;
+            }
+
+            /// Set the memory pressure level at which the memory kept by this
+            /// registration (retained singletons, NUMA replicas) is released
+            /// (default: MemoryPressure::Moderate).
+            InterfaceForType& evictAt(MemoryPressure level)
+            {
+                lock_guard<mutex_type> lockGuard{ _diFactory._mutex };
+
+                _registration->setEvictionLevel(level);
+                return *this;
             }
 
         private:
@@ -198,6 +356,7 @@ namespace CppDiFactory
 
         private:
             DiFactory& _diFactory;
+            shared_ptr<AbstractRegistration> _registration;
         };
 
         /// Register a new class and its dependencies.
@@ -210,22 +369,25 @@ namespace CppDiFactory
         template <typename Class, typename... Dependencies>
         InterfaceForType<Class> registerClass()
         {
-            lock_guard<mutex_type> lockGuard{ _mutex };
-
-             addRegistration<Class>(make_shared<ClassRegistration<Class, Dependencies...> >());
-            
-            return InterfaceForType<Class>(*this);
+            return addRegistrationSynchronized<Class>(make_shared<ClassRegistration<Class, Dependencies...> >());
         }
 
 
+        /// Register the root of a Composite (an object graph stored in a single object).
+        /// Getting an instance of the root type creates a new composite with a single
+        /// allocation; the returned pointer to the root keeps the whole composite alive.
+        /// \tparam CompositeType  Composite<...> type, the members of the composite
+        ///         are not registered in the factory.
+        template <typename CompositeType>
+        InterfaceForType<typename CompositeType::root_type> registerComposite()
+        {
+            return addRegistrationSynchronized<typename CompositeType::root_type>(make_shared<CompositeRegistration<CompositeType> >());
+        }
+
         template <typename Class>
         InterfaceForType<Class> registerInstance(shared_ptr<Class> instance)
         {
-            lock_guard<mutex_type> lockGuard{ _mutex };
-
-            addRegistration<Class>(make_shared<InstanceRegistration<Class> >(instance));
-
-            return InterfaceForType<Class>(*this);
+            return addRegistrationSynchronized<Class>(make_shared<InstanceRegistration<Class> >(instance));
         }
 
 
@@ -242,11 +404,7 @@ namespace CppDiFactory
         template <typename Class, typename... Dependencies>
         InterfaceForType<Class> registerInstancePerRequest()
         {
-            lock_guard<mutex_type> lockGuard{ _mutex };
-
-            addRegistration<Class>(make_shared<SingleInstancePerRequestRegistration<Class, Dependencies...> >());
-
-            return InterfaceForType<Class>(*this);
+            return addRegistrationSynchronized<Class>(make_shared<SingleInstancePerRequestRegistration<Class, Dependencies...> >());
         }
 
 
@@ -269,11 +427,7 @@ namespace CppDiFactory
         template <typename Class>
         InterfaceForType<Class> registerInstanceProvidedAtRequest()
         {
-            lock_guard<mutex_type> lockGuard{ _mutex };
-
-            addRegistration<Class>(make_shared<InstanceProvidedAtRequestRegistration<Class> >());
-
-            return InterfaceForType<Class>(*this);
+            return addRegistrationSynchronized<Class>(make_shared<InstanceProvidedAtRequestRegistration<Class> >());
         }
 
 
@@ -293,14 +447,208 @@ namespace CppDiFactory
         ///       registerInstance instead.
         template <typename Class, typename... Dependencies>
         InterfaceForType<Class> registerSingleton()
+        {
+            return addRegistrationSynchronized<Class>(make_shared<SingletonRegistration<Class, Dependencies...> >());
+        }
+
+
+        /// Register a new class which is rebuilt periodically in the background
+        /// (stale-while-revalidate).
+        /// The first request creates the instance, afterwards requests always
+        /// return the current instance without waiting. Every interval a new
+        /// instance is created in the background and published atomically;
+        /// users of the previous instance keep it as long as they need it.
+        /// If rebuilding fails, the previous instance stays in use.
+        /// The instance is kept alive by the factory (like registerInstance).
+        /// \tparam Class  Type of class which should be registered
+        /// \tparam Dependencies  List of dependencies of this class.
+        /// \param interval  time between two rebuilds (zero: only rebuild on refresh)
+        /// \param executor  executor for rebuilding (nullptr: executor of the factory)
+        template <typename Class, typename... Dependencies>
+        InterfaceForType<Class> registerRefreshing(std::chrono::steady_clock::duration interval, shared_ptr<Executor> executor = nullptr)
         {
             lock_guard<mutex_type> lockGuard{ _mutex };
 
-            addRegistration<Class>(make_shared<SingletonRegistration<Class, Dependencies...> >());
+            auto registration = make_shared<RefreshingRegistration<Class, Dependencies...> >();
+            InterfaceForType<Class> result = addRegistration<Class>(registration);
+            if (interval > std::chrono::steady_clock::duration::zero()){
+                scheduleRefresh(type_id<Class>(), registration->periodicRefresh(), interval, executor);
+            }
+            return result;
+        }
+
+        /// Register a trivially copyable (pointer-free) class whose instance is
+        /// persisted in an image file.
+        /// The first request maps the image file (copy-on-write) and returns the
+        /// mapped object without running the constructor. If there is no valid
+        /// image, the instance is constructed and written to the image file,
+        /// so the next process start can map it.
+        /// The instance is kept alive by the factory (like registerInstance).
+        /// Modifications of a mapped instance are not written to the image file.
+        /// \tparam Class  Type of class which should be registered, declared as
+        ///         pointer-free by specializing MappableImage
+        /// \tparam Dependencies  List of dependencies of this class (only
+        ///         resolved if the instance has to be constructed).
+        /// \param path  path of the image file
+        /// \param version  version of the layout of Class (and of the meaning of
+        ///         its data); images with another version are not mapped
+        template <typename Class, typename... Dependencies>
+        InterfaceForType<Class> registerMappedImage(const std::string& path, uint64_t version)
+        {
+            static_assert(std::is_trivially_copyable<Class>::value, "mapped images require trivially copyable types");
+            static_assert(MappableImage<Class>::value, "mapped images require pointer-free types, specialize CppDiFactory::MappableImage");
+
+            return addRegistrationSynchronized<Class>(make_shared<MappedImageRegistration<Class, Dependencies...> >(path, version));
+        }
+
+        /// Rebuild the instance of a type registered with registerRefreshing
+        /// on the calling thread and publish it.
+        /// The dependencies are resolved with the factory locked, but the
+        /// constructor runs without blocking other requests.
+        template <typename T>
+        void refresh()
+        {
+            refreshRegistration(type_id<T>());
+        }
+
+        /// Rebuild the shared instances (singletons and refreshing singletons) which
+        /// (transitively) depend on a type registered again since the last rebuild,
+        /// so they use the new registration instead of keeping the previous one
+        /// until they expire.
+        /// Only instances which are alive are rebuilt (together with the shared
+        /// instances they need), others are created with the next request.
+        /// The new instances are created one level of the dependency graph after
+        /// the other on the executor of the factory; requests are not blocked and
+        /// keep getting the previous instances meanwhile. Once all instances are
+        /// created, they are published at once. Users of the previous instances
+        /// keep them as long as they need them.
+        /// If a construction fails or the registrations change while rebuilding,
+        /// nothing is published and the changes stay pending (the exception of a
+        /// failed construction is rethrown).
+        /// Throws an exception if the registrations are not valid.
+        /// \return number of instances rebuilt
+        size_t rebuildAffected()
+        {
+            std::vector<std::vector<size_t> > levels;
+            uint64_t generation;
+            {
+                lock_guard<mutex_type> lockGuard{ _mutex };
+
+                const ReachabilityIndex& index = reachabilityIndex();
+                std::unordered_set<size_t> affected;
+                for (size_t typeId : index.topologicalOrder()){
+                    const AbstractRegistration& registration = findRegistration(typeId);
+                    if (!isRebuildable(registration)){
+                        continue;
+                    }
+                    bool changed = _changedTypes.count(typeId) != 0;
+                    for (size_t dependency : index.dependenciesOf(typeId)){
+                        changed = changed || _changedTypes.count(dependency) != 0;
+                    }
+                    if (changed){
+                        affected.insert(typeId);
+                    }
+                }
+
+                // alive instances and the affected shared instances they use
+                std::unordered_set<size_t> selected;
+                for (size_t typeId : affected){
+                    if (findRegistration(typeId).hasSharedInstance()){
+                        selected.insert(typeId);
+                        for (size_t dependency : index.dependenciesOf(typeId)){
+                            if (affected.count(dependency)){
+                                selected.insert(dependency);
+                            }
+                        }
+                    }
+                }
+
+                levels = dependencyLevels(selected);
+                generation = _registrationGeneration;
+            }
+
+            GenericPtrMap rebuilt;
+            // the constructions use their registrations, which may be replaced meanwhile
+            std::vector<shared_ptr<AbstractRegistration> > registrations;
+            for (const std::vector<size_t>& level : levels){
+                std::vector<std::function<GenericPtr()> > constructions;
+                shared_ptr<Executor> executor;
+                {
+                    lock_guard<mutex_type> lockGuard{ _mutex };
+
+                    if (generation != _registrationGeneration){
+                        return 0;
+                    }
+                    // dependencies rebuilt on lower levels are taken from rebuilt
+                    struct Staging
+                    {
+                        ~Staging() { diFactory._rebuiltInstances = nullptr; }
+                        DiFactory& diFactory;
+                    } staging{ *this };
+                    _rebuiltInstances = &rebuilt;
+                    for (size_t typeId : level){
+                        registrations.push_back(findRegistration(typeId).shared_from_this());
+                        constructions.push_back(limited(*registrations.back(), registrations.back()->bindRebuild(*this)));
+                    }
+                    executor = factoryExecutor();
+                }
+
+                const std::vector<GenericPtr> instances = waitForConstructions(runConstructions(constructions, executor));
+                for (size_t i = 0; i < level.size(); ++i){
+                    rebuilt[level[i]] = instances[i];
+                }
+            }
+
+            lock_guard<mutex_type> lockGuard{ _mutex };
 
-            return InterfaceForType<Class>(*this);
+            if (generation != _registrationGeneration){
+                return 0;
+            }
+            for (auto& instance : rebuilt){
+                findRegistration(instance.first).publishRebuild(*this, instance.second);
+            }
+            _changedTypes.clear();
+            return rebuilt.size();
         }
 
+        /// Let singletons share a single lifetime. Once an expired member is
+        /// needed, all expired members are constructed together: one dependency
+        /// level after the other, the members of a level in parallel on the
+        /// supplied executor. Each member instance keeps the whole group alive,
+        /// so the members are released together once none of them is used.
+        /// \tparam Members  classes registered with registerSingleton
+        /// \param executor  executor for constructing the members of a level
+        ///        (nullptr: on the requesting thread).
+        /// \note As for constructOn, the constructors must not use the DiFactory
+        ///       and the executor must not wait for the DiFactory.
+        /// \note Members already registered (and registered later on) must be
+        ///       registered with registerSingleton.
+        template <typename... Members>
+        void registerLifetimeGroup(shared_ptr<Executor> executor = nullptr)
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            checkNotFrozen();
+            auto group = make_shared<LifetimeGroup>();
+            group->members = std::vector<size_t>{ type_id<Members>()... };
+            group->executor = executor;
+            for (size_t member : group->members){
+                if (_lifetimeGroups.count(member)){
+                    throw new std::logic_error("Type is already member of a lifetime group");
+                }
+                const auto it = _registeredTypes.find(member);
+                if (it != _registeredTypes.end() && it->second->kind() != RegistrationKind::Singleton){
+                    throw new std::logic_error("Lifetime group member is not registered with registerSingleton");
+                }
+            }
+            for (size_t member : group->members){
+                _lifetimeGroups[member] = group;
+            }
+            if (executor){
+                // the group is constructed with the factory locked, waiting for the executor
+                _constructionExecutors = true;
+            }
+        }
 
         /// Register a new interface and defines which class is used
         /// as implementation.
@@ -312,12 +660,31 @@ namespace CppDiFactory
         ///         of the constructor for the specified class.
         template <typename Class, typename Interface>
         void registerInterface()
+        {
+            addRegistrationSynchronized<Interface>(make_shared<InterfaceRegistration<Interface, Class> >());
+        }
+
+
+        /// Allocate all instances created for registerSingleton types (including
+        /// their shared_ptr control blocks) from a dedicated contiguous region
+        /// instead of the regular heap.
+        /// This keeps the long-lived objects together (in dependency order) and
+        /// separated from short-lived objects.
+        /// If the region is exhausted, the regular heap is used.
+        /// \param capacity   size of the region in bytes
+        /// \param hugePages  page backing of the region
+        void useLongLivedRegion(size_t capacity, HugePages hugePages = HugePages::None)
         {
             lock_guard<mutex_type> lockGuard{ _mutex };
 
-            addRegistration<Interface>(make_shared<InterfaceRegistration<Interface, Class> >());
+            _longLivedRegion = make_shared<LongLivedRegion>(capacity, hugePages);
         }
 
+        /// Get the region used for long-lived instances (nullptr if none is used).
+        shared_ptr<const LongLivedRegion> longLivedRegion() const
+        {
+            return _longLivedRegion;
+        }
 
         /// Unregister the specified type.
         template <typename T>
@@ -325,14 +692,48 @@ namespace CppDiFactory
         {
             lock_guard<mutex_type> lockGuard{ _mutex };
 
+            CPPDIFACTORY_PROBE2(unregister_type, type_id<T>(), typeid(T).name());
+            checkNotFrozen();
+
             auto it = _registeredTypes.find(type_id<T>());
             if (it != _registeredTypes.end()){
+                retireRegistration(*it->second);
                 _registeredTypes.erase(it);
             }
+            ++_registrationGeneration;
 
-            for (auto itr : _registeredTypes){
-                itr.second->invalidate();
+            invalidateAll();
+        }
+
+        /// Freeze the registrations: all types are validated and no types can be
+        /// registered or unregistered any longer. Requests then find the
+        /// registrations in a compact read-only lookup table instead of the
+        /// hash map used while registering.
+        /// \param replicatePerNumaNode  keep one copy of the lookup table per NUMA
+        ///        node (allocated on that node); each request uses the copy of the
+        ///        node it is running on. The registrations themselves (including
+        ///        the singleton instances) are shared by all nodes.
+        void freeze(bool replicatePerNumaNode = false)
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            validateAll();
+
+            std::vector<std::pair<size_t, AbstractRegistration*> > entries;
+            for (auto it: _registeredTypes){
+                entries.push_back(std::make_pair(it.first, it.second.get()));
             }
+            _frozenRegistry.build(entries, replicatePerNumaNode);
+            if (replicatePerNumaNode){
+                _threadDependentRequests = true;
+            }
+        }
+
+        bool isFrozen()
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            return _frozenRegistry.built();
         }
 
         /// Get an instance of the specified type.
@@ -348,19 +749,222 @@ namespace CppDiFactory
         /// @param instances Instance parameters which will be used
         ///                  for the according InstanceProvidedAtRequest and
         ///                  SingleInstancePerRequest types.
+        /// If a request scope of this factory is active on the current thread
+        /// (see RequestScope::Activation), the request is part of that scope.
         template <typename T, typename... Instances>
         shared_ptr<T> getInstance(const std::shared_ptr<Instances>&... instances)
         {
+            CPPDIFACTORY_PROBE2(get_instance_entry, type_id<T>(), typeid(T).name());
+            const uint64_t start = CPPDIFACTORY_PROBE_START(get_instance_return);
+
+            GenericPtrMap typeInstanceMap;
+            GenericPtrMap& requestInstances = activeScopeInstances(typeInstanceMap);
+            shared_ptr<T> instance;
+
+            synchronized([&]() {
+                RegisterInstanceForRequest(requestInstances, instances...);
+                instance = resolve<T>(requestInstances);
+            });
+
+            CPPDIFACTORY_PROBE3(get_instance_return, type_id<T>(), typeid(T).name(), probeElapsed(start));
+            (void)start;
+            return instance;
+        }
+
+        /// Start a logical request spanning several calls of getInstance, e.g. an
+        /// asynchronous request handler continuing on other threads.
+        /// All requests made with the returned scope (or while it is active on the
+        /// requesting thread, see RequestScope::Activation) share the
+        /// SingleInstancePerRequest instances and the supplied instances.
+        /// @param instances Instance parameters (see getInstance)
+        template <typename... Instances>
+        RequestScope beginRequest(const std::shared_ptr<Instances>&... instances)
+        {
+            RequestScope scope(make_shared<RequestScope::State>(*this));
+
             lock_guard<mutex_type> lockGuard{ _mutex };
-            AbstractRegistration& registration = findRegistration<T>();
-            registration.validate(*this);
+            RegisterInstanceForRequest(scope._state->instances, instances...);
+            return scope;
+        }
+
+        /// Get an instance of the specified type within a request scope (see beginRequest).
+        /// @param scope     scope created by this factory
+        /// @param instances Instance parameters added to the scope (see getInstance)
+        template <typename T, typename... Instances>
+        shared_ptr<T> getInstance(const RequestScope& scope, const std::shared_ptr<Instances>&... instances)
+        {
+            CPPDIFACTORY_PROBE2(get_instance_entry, type_id<T>(), typeid(T).name());
+            const uint64_t start = CPPDIFACTORY_PROBE_START(get_instance_return);
+
+            shared_ptr<T> instance;
+
+            synchronized([&]() {
+                GenericPtrMap& requestInstances = scopeInstances(scope);
+                RegisterInstanceForRequest(requestInstances, instances...);
+                instance = resolve<T>(requestInstances);
+            });
+
+            CPPDIFACTORY_PROBE3(get_instance_return, type_id<T>(), typeid(T).name(), probeElapsed(start));
+            (void)start;
+            return instance;
+        }
+
+        /// Get an instance of the specified type and record the request for the
+        /// supplied call site (if call site statistics are enabled).
+        /// \code
+        ///   auto a = diFactory.getInstance<IntfA1>(CPPDIFACTORY_CALL_SITE);
+        ///   auto b = diFactory.getInstance<IntfB>(CppDiFactory::CallSite("request handler"));
+        /// \endcode
+        /// @see getInstance, enableCallSiteStatistics
+        template <typename T, typename... Instances>
+        shared_ptr<T> getInstance(const CallSite& callSite, const std::shared_ptr<Instances>&... instances)
+        {
+            if (!_callSites.enabled()){
+                return getInstance<T>(instances...);
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            shared_ptr<T> instance = getInstance<T>(instances...);
+            _callSites.record(callSite, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start));
+            return instance;
+        }
+
+        /// Enable (or disable) aggregating the number and duration of requests
+        /// per call site for requests made with a CallSite.
+        void enableCallSiteStatistics(bool enable = true)
+        {
+            _callSites.enable(enable);
+        }
+
+        /// Get the aggregated requests per call site, most expensive call sites first.
+        std::vector<CallSiteStatistics> callSiteStatistics() const
+        {
+            return _callSites.statistics();
+        }
+
+        void resetCallSiteStatistics()
+        {
+            _callSites.reset();
+        }
+
+        /// Get an instance of the specified type asynchronously.
+        /// The request is run on the executor of the factory (see setExecutor).
+        /// Types constructed on an executor (see InterfaceForType::constructOn)
+        /// are resolved there as well, only their constructors are run on their
+        /// executor (which therefore never waits for the factory).
+        /// Errors are reported through the returned future.
+        /// A request scope active on the calling thread is used by the request.
+        /// @tparam T         Type which should be return
+        /// @tparam Instances Type of instance parameters supplied
+        /// @param instances Instance parameters (see getInstance)
+        template <typename T, typename... Instances>
+        std::future<shared_ptr<T> > getInstanceAsync(const std::shared_ptr<Instances>&... instances)
+        {
+            auto promise = make_shared<std::promise<shared_ptr<T> > >();
             GenericPtrMap typeInstanceMap;
+            RequestScope scope;
+            shared_ptr<Executor> executor;
 
-            RegisterInstanceForRequest(typeInstanceMap, instances...);
+            try {
+                lock_guard<mutex_type> lockGuard{ _mutex };
 
-            return registration.getTypedInstance<T>(*this, typeInstanceMap);
+                const RequestScope& active = RequestScope::current();
+                if (active && &active._state->factory == this){
+                    scope = active;
+                }
+                RegisterInstanceForRequest(scope ? scope._state->instances : typeInstanceMap, instances...);
+                executor = factoryExecutor();
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+                return promise->get_future();
+            }
+
+            shared_ptr<TaskGuard> guard = _backgroundTasks;
+            auto task = [this, guard, promise, typeInstanceMap, scope]() mutable {
+                if (!guard->enter()){
+                    promise->set_exception(std::make_exception_ptr(new std::logic_error("DiFactory destroyed")));
+                    return;
+                }
+                try {
+                    lock_guard<mutex_type> lockGuard{ _mutex };
+                    promise->set_value(resolve<T>(scope ? scope._state->instances : typeInstanceMap));
+                } catch (...) {
+                    promise->set_exception(std::current_exception());
+                }
+                guard->leave();
+            };
+
+            if (executor && !executor->runsInCurrentThread()){
+                executor->execute(task);
+            } else {
+                task();
+            }
+            return promise->get_future();
+        }
+
+
+        /// Set the executor for background work of the factory (asynchronous
+        /// requests and background refreshes without an executor of their own).
+        /// By default, a WorkStealingExecutor with one thread per hardware thread
+        /// is created when it is needed for the first time. Use ExecutorAdapter
+        /// (or an own implementation of Executor) to use an existing thread pool.
+        void setExecutor(shared_ptr<Executor> executor)
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            _executor = executor;
+        }
+
+        /// Get the executor for background work of the factory (see setExecutor).
+        shared_ptr<Executor> executor()
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            return factoryExecutor();
+        }
+
+        /// Release memory which is only kept to speed up requests:
+        ///   - retained singletons (see InterfaceForType::retain)
+        ///   - NUMA replicas of registered instances (the original instance is used again)
+        ///   - unused pages of the long-lived region
+        /// Each registration is only released if level reaches its eviction level
+        /// (see InterfaceForType::evictAt); MemoryPressure::Low releases nothing.
+        /// Instances still used elsewhere are destroyed once they are released there.
+        void onMemoryPressure(MemoryPressure level)
+        {
+            std::vector<GenericPtr> released;
+            {
+                lock_guard<mutex_type> lockGuard{ _mutex };
+
+                if (level == MemoryPressure::Low){
+                    return;
+                }
+                for (auto it: _registeredTypes){
+                    it.second->releaseMemory(level, released);
+                }
+                if (_longLivedRegion){
+                    _longLivedRegion->releaseSlack();
+                }
+            }
+            // the released instances are destroyed without the factory being locked
         }
 
+        /// Call onMemoryPressure automatically when the kernel reports memory
+        /// stalls (Linux pressure stall information, see MemoryPressureWatcher).
+        /// Use the memory.pressure file of a cgroup to watch a container.
+        /// \note Call this while setting up the factory, not concurrently with
+        ///       other calls of watchMemoryPressure.
+        /// \return false if pressure stall information is not available
+        bool watchMemoryPressure(const std::string& path = "/proc/pressure/memory")
+        {
+            shared_ptr<TaskGuard> guard = _backgroundTasks;
+            return _memoryPressureWatcher.start(path, [this, guard](MemoryPressure level) {
+                if (guard->enter()){
+                    onMemoryPressure(level);
+                    guard->leave();
+                }
+            });
+        }
 
         /// Ensure that there are no registration errors for all types.
         /// The following errors can be detected:
@@ -369,82 +973,560 @@ namespace CppDiFactory
         ///   - Dependencies from singletons to "Single Instance Per Request"
         ///     types.
         /// If an error is detected, an exception will be thrown.
+        /// After a successful validation the reachability index used by
+        /// dependsOn, transitiveDependencies and dependents is up to date.
         void validate()
         {
             lock_guard<mutex_type> lockGuard{ _mutex };
 
-            for (auto it: _registeredTypes){
-                it.second->validate(*this);
+            validateAll();
+        }
+
+#if !defined(CPPDIFACTORY_NO_INTERCEPTORS)
+        /// Install an interceptor whose hooks are called for requests, constructions
+        /// and singleton creation/expiry of this factory (nullptr: remove it).
+        /// Replaced interceptors are kept alive until the factory is destroyed,
+        /// as hooks may still be running on other threads.
+        /// Define CPPDIFACTORY_NO_INTERCEPTORS to remove all hooks at compile time.
+        void setInterceptor(shared_ptr<ConstructionInterceptor> interceptor)
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            if (interceptor){
+                _interceptors.push_back(interceptor);
+                _threadDependentRequests = true;
             }
+            _interceptor.store(interceptor.get(), std::memory_order_release);
         }
+#endif
 
-    private:
-        friend class AbstractRegistration;
+        /// Start (or stop) recording which types are requested, e.g. during the
+        /// first minutes of a run (see saveUsageProfile).
+        void recordUsage(bool enable = true)
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
 
-        using GenericPtr    = shared_ptr<void>;
-        using GenericPtrMap = unordered_map<size_t, GenericPtr>;
+            _recordUsage = enable;
+        }
 
-        /// Basic (untyped) class containing registration information
-        /// about a specific type.
-        /// Each type of registration has it's own Registration class derived from
-        /// this class. These derived classes implement the getInstance() behavior
-        /// and a validation of the dependencies.
-        /// One instance of such a class will be created (and stored) for each registered type.
-        class AbstractRegistration
+        /// Store the types requested since recordUsage was enabled.
+        /// \return false if the file could not be written
+        bool saveUsageProfile(const std::string& path)
         {
-        public:
-            virtual ~AbstractRegistration(){}
-            virtual GenericPtr getInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap) = 0;
-            virtual void checkAsParam()
+            std::vector<std::string> types;
             {
-                throw new std::logic_error("Not allowed as parameter");
-            }
+                lock_guard<mutex_type> lockGuard{ _mutex };
 
-            void validate(const DiFactory& diFactory)
-            {
-                if (!_validated){
-                    isValid(diFactory, this, _hasSiprDependency);
-                    _validated = true;
+                for (size_t typeId : _usedTypes){
+                    const auto it = _registeredTypes.find(typeId);
+                    if (it != _registeredTypes.end()){
+                        types.push_back(it->second->typeName());
+                    }
                 }
             }
+            std::sort(types.begin(), types.end());
+            return UsageProfile::store(path, types);
+        }
 
-            void validate(const DiFactory& diFactory, const AbstractRegistration* root, bool& hasSiprDependency)
+        /// Create the shared instances (singletons and refreshing singletons) used by
+        /// the types of a usage profile (see saveUsageProfile) before the first request.
+        /// Independent instances are created in parallel on the executor of the factory,
+        /// one level of the dependency graph after the other. The warmed-up singletons
+        /// are kept by the factory until they are released under memory pressure
+        /// (see onMemoryPressure).
+        /// Types which are not registered (any longer) are ignored, as well as
+        /// types which can not be created ahead of a request (e.g. because they
+        /// need instances provided at request).
+        /// \param failedTypes  receives the names of the types whose construction
+        ///        failed (nullptr: not reported); they are constructed with the
+        ///        first request instead
+        /// \return number of instances created
+        size_t warmUp(const std::string& profilePath, std::vector<std::string>* failedTypes = nullptr)
+        {
+            std::vector<std::string> types;
+            if (!UsageProfile::load(profilePath, types)){
+                return 0;
+            }
+
+            std::vector<size_t> typeIds;
             {
-                if (this == root){
-                    throw new std::logic_error("circular dependency");
-                }
+                lock_guard<mutex_type> lockGuard{ _mutex };
 
-                if (!_validated){
-                    isValid(diFactory, root, _hasSiprDependency);
-                    _validated = true;
+                unordered_map<std::string, size_t> byName;
+                for (auto it: _registeredTypes){
+                    byName[it.second->typeName()] = it.first;
+                }
+                for (const std::string& type : types){
+                    const auto it = byName.find(type);
+                    if (it != byName.end()){
+                        typeIds.push_back(it->second);
+                    }
                 }
-
-                hasSiprDependency = _hasSiprDependency;
             }
+            return warmUpTypes(typeIds, failedTypes);
+        }
 
-            void invalidate()
-            {
-                _validated = false;
-                _hasSiprDependency = false;
+        /// Measure the construction time of each type (constructor and allocation,
+        /// without resolving the dependencies) for analyzeStartup.
+        void enableConstructionTiming(bool enable = true)
+        {
+            _constructionTimer.enable(enable);
+        }
+
+        /// Analyze the measured construction times (see enableConstructionTiming):
+        /// the critical path is the longest chain of constructions which depend on
+        /// each other and therefore can not run in parallel. Only making the
+        /// constructors on this path faster (or lazy) reduces the time until all
+        /// instances are ready, even if all other constructions are done in parallel.
+        /// Throws an exception if the registrations are not valid.
+        StartupReport analyzeStartup()
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            const std::vector<size_t> order = reachabilityIndex().topologicalOrder();
+            std::vector<std::vector<size_t> > dependencies;
+            std::vector<std::chrono::nanoseconds> selfTime;
+            for (size_t typeId : order){
+                dependencies.push_back(findRegistration(typeId).dependencies());
+                selfTime.push_back(_constructionTimer.averageTime(typeId));
             }
 
-            template <typename T>
-            shared_ptr<T> getTypedInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
-            {
-                return static_pointer_cast<T>(getInstance(diFactory, typeInstanceMap));
+            StartupReport report{ {}, std::chrono::nanoseconds(0), std::chrono::nanoseconds(0), 1.0, _constructionTimer.times() };
+            for (ConstructionTime& time : report.types){
+                const auto it = _registeredTypes.find(time.typeId);
+                time.type = it != _registeredTypes.end() ? it->second->typeName() : std::string("?");
+                report.totalTime += time.averageTime();
+            }
+            std::sort(report.types.begin(), report.types.end(), [](const ConstructionTime& a, const ConstructionTime& b) {
+                return a.averageTime() > b.averageTime();
+            });
+
+            for (size_t typeId : longestPath(order, dependencies, selfTime)){
+                for (const ConstructionTime& time : report.types){
+                    if (time.typeId == typeId){
+                        report.criticalPath.push_back(time);
+                        report.criticalPathTime += time.averageTime();
+                    }
+                }
+            }
+            if (report.criticalPathTime.count() > 0){
+                report.parallelSpeedUp = static_cast<double>(report.totalTime.count()) / report.criticalPathTime.count();
             }
+            return report;
+        }
 
-        protected:
-            virtual void isValid(const DiFactory& diFactory, const AbstractRegistration* root, bool& hasSiprDependency) const = 0;
+        /// Clear the measured construction times.
+        void resetConstructionTiming()
+        {
+            _constructionTimer.reset();
+        }
 
-            template <typename T>
-            AbstractRegistration& findRegistration(const DiFactory& diFactory) const
-            {
+        /// Observe the instances created by the factory (constructions, instance
+        /// lifetimes, dependencies, singleton expiries and sharing within requests)
+        /// for adviseLifetimes.
+        /// While enabled, instances are allocated separately from their shared_ptr
+        /// control block (and not from the long-lived region) to track their lifetime.
+        void enableLifetimeAdvisor(bool enable = true)
+        {
+            _lifetimeRecorder->enable(enable);
+        }
+
+        /// Recommend lifetime changes per registration based on the observed
+        /// instances (see enableLifetimeAdvisor and LifetimeAdvice), together
+        /// with the constructions and allocations they save.
+        LifetimeReport adviseLifetimes(const LifetimeAdvisorOptions& options = LifetimeAdvisorOptions())
+        {
+            std::vector<LifetimeSubject> subjects;
+            {
+                lock_guard<mutex_type> lockGuard{ _mutex };
+
+                const std::unordered_map<size_t, LifetimeObservation> observations = _lifetimeRecorder->observations();
+                for (auto it: _registeredTypes){
+                    LifetimeSubject subject{ it.first, it.second->typeName(), it.second->kind(), {}, LifetimeObservation() };
+                    for (size_t dependency : it.second->dependencies()){
+                        subject.dependencies.push_back(implementingType(dependency));
+                    }
+                    const auto observation = observations.find(it.first);
+                    if (observation != observations.end()){
+                        subject.observation = observation->second;
+                    }
+                    subjects.push_back(subject);
+                }
+            }
+            return CppDiFactory::adviseLifetimes(subjects, options);
+        }
+
+        /// Clear the observations of the lifetime advisor.
+        void resetLifetimeObservations()
+        {
+            _lifetimeRecorder->reset();
+        }
+
+        /// Set how captive dependencies are handled. A captive dependency is a
+        /// dependency of a longer-lived instance on a type with a shorter lifetime
+        /// (e.g. a singleton depending on a registerClass type): the holder keeps
+        /// the captured instance alive for its whole lifetime.
+        /// The check is done for all types whenever they are validated.
+        /// \param policy    default: CaptiveDependencyPolicy::Report
+        /// \param reporter  called for each captive dependency found (Report only)
+        void setCaptiveDependencyPolicy(CaptiveDependencyPolicy policy,
+                                        std::function<void(const CaptiveDependency&)> reporter = nullptr)
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            _captivePolicy = policy;
+            _captiveReporter = reporter;
+            _captivesValid = false;
+        }
+
+        /// Get all captive dependencies (see setCaptiveDependencyPolicy) of the
+        /// registered types, independent of the policy.
+        std::vector<CaptiveDependency> captiveDependencies()
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            return findCaptiveDependencies();
+        }
+
+        /// Get the kind of registration of type T.
+        template <typename T>
+        RegistrationKind registrationKind()
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            return findRegistration<T>().kind();
+        }
+
+        /// Keep the validation results in the supplied file and skip the validation
+        /// if the registrations did not change since the file was written
+        /// (see registryFingerprint). The reachability index used by dependsOn
+        /// etc. is only built when it is needed if the results were loaded.
+        /// \param path  cache file (empty: no cache)
+        void setValidationCache(const std::string& path)
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            _validationCachePath = path;
+            _validationCacheState = ValidationCacheState::Unchecked;
+        }
+
+        /// Fingerprint of all registrations (type names, kinds and dependencies),
+        /// which is stable across runs of the same program.
+        uint64_t registryFingerprint()
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            return computeFingerprint();
+        }
+
+        /// Check if type T (transitively) depends on type Dependency.
+        /// Interfaces and the classes implementing them are separate nodes, e.g.
+        /// a class depending on an interface also depends on the class
+        /// implementing that interface.
+        /// If the registrations changed since the last validation, all types are
+        /// validated again (and an exception is thrown on registration errors).
+        template <typename T, typename Dependency>
+        bool dependsOn()
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            return reachabilityIndex().dependsOn(type_id<T>(), type_id<Dependency>());
+        }
+
+        /// Get the type ids (see type_id) of all types T transitively depends on.
+        template <typename T>
+        std::vector<size_t> transitiveDependencies()
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            return reachabilityIndex().dependenciesOf(type_id<T>());
+        }
+
+        /// Get the type ids (see type_id) of all types which transitively depend on T.
+        template <typename T>
+        std::vector<size_t> dependents()
+        {
+            lock_guard<mutex_type> lockGuard{ _mutex };
+
+            return reachabilityIndex().dependentsOf(type_id<T>());
+        }
+
+    private:
+        friend class AbstractRegistration;
+
+        using GenericPtr    = shared_ptr<void>;
+        using GenericPtrMap = unordered_map<size_t, GenericPtr>;
+
+        /// Basic (untyped) class containing registration information
+        /// about a specific type.
+        /// Each type of registration has it's own Registration class derived from
+        /// this class. These derived classes implement the getInstance() behavior
+        /// and a validation of the dependencies.
+        /// One instance of such a class will be created (and stored) for each registered type.
+        class AbstractRegistration: public std::enable_shared_from_this<AbstractRegistration>
+        {
+        public:
+            AbstractRegistration(): _validated(false), _hasSiprDependency(false), _typeId(0), _type(&typeid(void)), _stableHash(0), _evictionLevel(MemoryPressure::Moderate) {}
+            virtual ~AbstractRegistration(){}
+            virtual GenericPtr getInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap) = 0;
+            virtual RegistrationKind kind() const = 0;
+            virtual void checkAsParam()
+            {
+                throw new std::logic_error("Not allowed as parameter");
+            }
+
+            virtual void setConstructionExecutor(shared_ptr<Executor>)
+            {
+                throw new std::logic_error("Instances of this type are not constructed by the factory");
+            }
+
+            virtual void setConstructionLimiter(shared_ptr<ConstructionLimiter>)
+            {
+                throw new std::logic_error("Instances of this type are not constructed by the factory");
+            }
+
+            /// Limiter for the constructions running without the factory being locked (nullptr: none).
+            virtual shared_ptr<ConstructionLimiter> constructionLimiter() const
+            {
+                return nullptr;
+            }
+
+            virtual void replicatePerNumaNode()
+            {
+                throw new std::logic_error("Only registered instances can be replicated");
+            }
+
+            virtual void retain()
+            {
+                throw new std::logic_error("Only singletons can be retained");
+            }
+
+            /// The registration has been unregistered or replaced (the factory is locked).
+            virtual void retire()
+            {
+                //empty
+            }
+
+            void setType(size_t typeId, const std::type_info& type)
+            {
+                _typeId = typeId;
+                _type = &type;
+                _stableHash = computeStableHash();
+            }
+
+            /// Hash of the registered type, kind and dependencies (see registryFingerprint),
+            /// which is the same in every run of the same program.
+            uint64_t stableHash() const
+            {
+                return _stableHash;
+            }
+
+            /// Id of the registered type (see type_id).
+            size_t typeId() const
+            {
+                return _typeId;
+            }
+
+            const std::type_info& typeInfo() const
+            {
+                return *_type;
+            }
+
+            /// Readable name of the registered type.
+            std::string typeName() const
+            {
+                return CppDiFactory::typeName(*_type);
+            }
+
+            void setEvictionLevel(MemoryPressure level)
+            {
+                _evictionLevel = level;
+            }
+
+            /// Drop the memory kept by this registration if level reaches the eviction level.
+            /// The dropped instances are moved to released (to be destroyed without the factory being locked).
+            void releaseMemory(MemoryPressure level, std::vector<GenericPtr>& released)
+            {
+                if (level >= _evictionLevel){
+                    dropCachedInstances(released);
+                }
+            }
+
+            /// Create a new instance exclusively owned by the caller (see Unique).
+            /// \return pointer to the registered type
+            virtual void* createOwned(const DiFactory&, GenericPtrMap&)
+            {
+                throw new std::logic_error("Instances of this type can not be exclusively owned");
+            }
+
+            /// Check if createOwned can be used for this type.
+            virtual bool isExclusivelyOwnable(const DiFactory&) const
+            {
+                return false;
+            }
+
+            /// Type ids of the direct dependencies.
+            virtual std::vector<size_t> dependencies() const
+            {
+                return std::vector<size_t>();
+            }
+
+            /// Types of the direct dependencies (in the order of dependencies).
+            virtual std::vector<const std::type_info*> dependencyTypes() const
+            {
+                return std::vector<const std::type_info*>();
+            }
+
+            /// Which of the direct dependencies are exclusively owned (see Unique).
+            virtual std::vector<bool> ownedDependencies() const
+            {
+                return std::vector<bool>(dependencies().size(), false);
+            }
+
+            /// Resolve the dependencies for creating the shared instance ahead of the first
+            /// request (the factory is locked). The returned function creates the instance
+            /// and is called without the factory being locked.
+            /// \return nullptr if there is nothing to create
+            virtual std::function<GenericPtr()> bindWarmUp(const DiFactory&)
+            {
+                return nullptr;
+            }
+
+            /// Publish an instance created by the function returned by bindWarmUp (the factory is locked).
+            virtual void publishWarmUp(const DiFactory&, const GenericPtr&)
+            {
+                //empty
+            }
+
+            /// Check if the shared instance of this registration currently exists.
+            virtual bool hasSharedInstance() const
+            {
+                return false;
+            }
+
+            /// Resolve the dependencies for replacing the shared instance (the factory is locked,
+            /// see rebuildAffected). The returned function creates the new instance
+            /// and is called without the factory being locked.
+            virtual std::function<GenericPtr()> bindRebuild(const DiFactory&)
+            {
+                throw new std::logic_error("Instances of this type can not be rebuilt");
+            }
+
+            /// Replace the shared instance by one created by the function returned by bindRebuild (the factory is locked).
+            virtual void publishRebuild(const DiFactory&, const GenericPtr&)
+            {
+                throw new std::logic_error("Instances of this type can not be rebuilt");
+            }
+
+            /// Publish the expired shared instance constructed for its lifetime group
+            /// (see registerLifetimeGroup, the factory is locked).
+            virtual void publishGroupMember(const DiFactory&, const GenericPtr&)
+            {
+                throw new std::logic_error("Lifetime group member is not registered with registerSingleton");
+            }
+
+            /// Resolve the dependencies for rebuilding the instance (the factory is locked).
+            /// The returned function creates and publishes the new instance
+            /// and is called without the factory being locked.
+            virtual std::function<void()> prepareRefresh(const DiFactory&)
+            {
+                throw new std::logic_error("Type is not registered for refreshing");
+            }
+
+            void validate(const DiFactory& diFactory)
+            {
+                if (!_validated){
+                    isValid(diFactory, this, _hasSiprDependency);
+                    _validated = true;
+                }
+            }
+
+            void validate(const DiFactory& diFactory, const AbstractRegistration* root, bool& hasSiprDependency)
+            {
+                if (this == root){
+                    throw new std::logic_error("circular dependency");
+                }
+
+                if (!_validated){
+                    isValid(diFactory, root, _hasSiprDependency);
+                    _validated = true;
+                }
+
+                // accumulate, the caller validates all of its dependencies with the same flag
+                hasSiprDependency = hasSiprDependency || _hasSiprDependency;
+            }
+
+            /// Mark as valid without validation (e.g. with cached validation results).
+            void markValidated(bool hasSiprDependency)
+            {
+                _validated = true;
+                _hasSiprDependency = hasSiprDependency;
+            }
+
+            bool hasSiprDependency() const
+            {
+                return _hasSiprDependency;
+            }
+
+            void invalidate()
+            {
+                _validated = false;
+                _hasSiprDependency = false;
+            }
+
+            template <typename T>
+            shared_ptr<T> getTypedInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
+            {
+                return static_pointer_cast<T>(getInstance(diFactory, typeInstanceMap));
+            }
+
+        protected:
+            virtual void isValid(const DiFactory& diFactory, const AbstractRegistration* root, bool& hasSiprDependency) const = 0;
+
+            /// Instance of this type created by rebuildAffected but not published yet (nullptr if none).
+            GenericPtr rebuiltInstance(const DiFactory& diFactory) const
+            {
+                if (diFactory._rebuiltInstances){
+                    const auto it = diFactory._rebuiltInstances->find(_typeId);
+                    if (it != diFactory._rebuiltInstances->end()){
+                        return it->second;
+                    }
+                }
+                return nullptr;
+            }
+
+            virtual void dropCachedInstances(std::vector<GenericPtr>&)
+            {
+                //empty
+            }
+
+            template <typename T>
+            AbstractRegistration& findRegistration(const DiFactory& diFactory) const
+            {
                 return diFactory.findRegistration<T>();
             }
         private:
+            uint64_t computeStableHash() const
+            {
+                // mangled names, demangling is not needed to tell the types apart
+                RegistryFingerprint hash;
+                hash.add(std::string(_type->name()));
+                hash.add(static_cast<uint64_t>(kind()));
+                const std::vector<const std::type_info*> types = dependencyTypes();
+                const std::vector<bool> owned = ownedDependencies();
+                for (size_t i = 0; i < types.size(); ++i){
+                    hash.add(std::string(types[i]->name()));
+                    hash.add(static_cast<uint64_t>(owned[i]));
+                }
+                return hash.value();
+            }
+
             bool _validated;
             bool _hasSiprDependency;
+            size_t _typeId;
+            const std::type_info* _type;
+            uint64_t _stableHash;
+            MemoryPressure _evictionLevel;
         };
 
         /// registration for an interface implemented by a specified class
@@ -453,12 +1535,47 @@ namespace CppDiFactory
         {
         public:
             virtual ~InterfaceRegistration(){}
+
+            virtual RegistrationKind kind() const
+            {
+                return RegistrationKind::Interface;
+            }
             virtual GenericPtr getInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
             {
                 AbstractRegistration& concreteClass = findRegistration<Class>(diFactory);
                 return concreteClass.getInstance(diFactory, typeInstanceMap);
             }
 
+            virtual void* createOwned(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
+            {
+                if (!std::has_virtual_destructor<Interface>::value){
+                    throw new std::logic_error("Exclusively owned interface has no virtual destructor");
+                }
+                Class* instance = static_cast<Class*>(findRegistration<Class>(diFactory).createOwned(diFactory, typeInstanceMap));
+                return static_cast<Interface*>(instance);
+            }
+
+            /// The owner deletes the instance through the interface.
+            virtual bool isExclusivelyOwnable(const DiFactory& diFactory) const
+            {
+                return std::has_virtual_destructor<Interface>::value && findRegistration<Class>(diFactory).isExclusivelyOwnable(diFactory);
+            }
+
+            virtual std::vector<size_t> dependencies() const
+            {
+                return std::vector<size_t>{ type_id<Class>() };
+            }
+
+            virtual std::vector<const std::type_info*> dependencyTypes() const
+            {
+                return std::vector<const std::type_info*>{ &typeid(Class) };
+            }
+
+            virtual std::function<void()> prepareRefresh(const DiFactory& diFactory)
+            {
+                return findRegistration<Class>(diFactory).prepareRefresh(diFactory);
+            }
+
         protected:
             virtual void isValid(const DiFactory& diFactory, const AbstractRegistration* root, bool& hasSiprDependency) const
             {
@@ -473,9 +1590,58 @@ namespace CppDiFactory
         {
         public:
             virtual ~ClassRegistration(){}
+
+            virtual RegistrationKind kind() const
+            {
+                return RegistrationKind::Class;
+            }
             virtual GenericPtr getInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
             {
-                return make_shared<Class>(getDependencyInstance<Dependencies>(diFactory, typeInstanceMap)...);
+                return createInstance(diFactory, typeInstanceMap, false);
+            }
+
+            virtual void setConstructionExecutor(shared_ptr<Executor> executor)
+            {
+                _executor = executor;
+            }
+
+            virtual void setConstructionLimiter(shared_ptr<ConstructionLimiter> limiter)
+            {
+                _limiter = limiter;
+            }
+
+            virtual shared_ptr<ConstructionLimiter> constructionLimiter() const
+            {
+                return _limiter;
+            }
+
+            virtual std::vector<size_t> dependencies() const
+            {
+                return std::vector<size_t>{ type_id<typename DependencyType<Dependencies>::type>()... };
+            }
+
+            virtual std::vector<const std::type_info*> dependencyTypes() const
+            {
+                return std::vector<const std::type_info*>{ &typeid(typename DependencyType<Dependencies>::type)... };
+            }
+
+            virtual std::vector<bool> ownedDependencies() const
+            {
+                return std::vector<bool>{ DependencyType<Dependencies>::unique... };
+            }
+
+            virtual void* createOwned(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
+            {
+                if (!isExclusivelyOwnable(diFactory)){
+                    throw new std::logic_error("Instances of this type can not be exclusively owned");
+                }
+                return construct<std::unique_ptr<Class> >(diFactory, false, getDependencyInstance<Dependencies>(diFactory, typeInstanceMap)...).release();
+            }
+
+            /// Only regular classes, the derived registrations share their instances.
+            virtual bool isExclusivelyOwnable(const DiFactory&) const
+            {
+                return this->kind() == RegistrationKind::Class;
             }
 
         protected:
@@ -484,19 +1650,193 @@ namespace CppDiFactory
                 call(isDependencyValid<Dependencies>(diFactory, root, hasSiprDependency)...);
             }
 
+            /// Resolve the dependencies and create a new instance.
+            /// \param longLived  allocate the instance from the long-lived region (if any)
+            shared_ptr<Class> createInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap, bool longLived)
+            {
+                return construct<shared_ptr<Class> >(diFactory, longLived, getDependencyInstance<Dependencies>(diFactory, typeInstanceMap)...);
+            }
+
+            /// Resolve the dependencies and return a function which creates a new
+            /// instance using these dependencies (e.g. for creating the instance
+            /// without the factory being locked).
+            std::function<shared_ptr<Class>()> bindConstruction(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap, bool longLived)
+            {
+                return bindArguments(diFactory, longLived, getDependencyInstance<Dependencies>(diFactory, typeInstanceMap)...);
+            }
+
+            /// Create a new instance, owned by a Pointer (shared_ptr or unique_ptr of Class).
+            template <typename Pointer, typename... Args>
+            Pointer construct(const DiFactory& diFactory, bool longLived, Args&&... args)
+            {
+                CPPDIFACTORY_PROBE2(construct_entry, type_id<Class>(), typeid(Class).name());
+                CPPDIFACTORY_INTERCEPT(diFactory, beforeConstruction, *this, nullptr);
+                const uint64_t start = CPPDIFACTORY_PROBE_START(construct_return);
+
+                Pointer instance = constructOnExecutor<Pointer>(diFactory, longLived, std::forward<Args>(args)...);
+
+                CPPDIFACTORY_PROBE3(construct_return, type_id<Class>(), typeid(Class).name(), probeElapsed(start));
+                CPPDIFACTORY_INTERCEPT(diFactory, afterConstruction, *this, instance.get());
+                (void)start;
+                return instance;
+            }
+
+            template <typename Pointer, typename... Args>
+            Pointer constructOnExecutor(const DiFactory& diFactory, bool longLived, Args&&... args)
+            {
+                if (_executor && !_executor->runsInCurrentThread()){
+                    // the arguments stay alive, as we wait for the construction to finish
+                    std::promise<Pointer> promise;
+                    _executor->execute([&]() {
+                        try {
+                            promise.set_value(allocate<Pointer>(diFactory, longLived, std::forward<Args>(args)...));
+                        } catch (...) {
+                            promise.set_exception(std::current_exception());
+                        }
+                    });
+                    return promise.get_future().get();
+                }
+                return allocate<Pointer>(diFactory, longLived, std::forward<Args>(args)...);
+            }
+
+            template <typename Pointer, typename... Args>
+            Pointer allocate(const DiFactory& diFactory, bool longLived, Args&&... args)
+            {
+                const bool observed = diFactory._lifetimeRecorder->enabled();
+                if (diFactory._constructionTimer.enabled() || observed){
+                    const uint64_t identity = observed ? dependencyIdentity(args...) : 0;
+                    const auto start = std::chrono::steady_clock::now();
+                    Pointer instance = observed ? allocateObserved(PointerType<Pointer>(), diFactory, std::forward<Args>(args)...)
+                                                : allocateUntimed(PointerType<Pointer>(), diFactory, longLived, std::forward<Args>(args)...);
+                    const std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - start;
+                    if (diFactory._constructionTimer.enabled()){
+                        diFactory._constructionTimer.record(this->typeId(), duration);
+                    }
+                    if (observed){
+                        diFactory._lifetimeRecorder->recordConstruction(this->typeId(), identity, duration, std::is_same<Pointer, shared_ptr<Class> >::value);
+                    }
+                    return instance;
+                }
+                return allocateUntimed(PointerType<Pointer>(), diFactory, longLived, std::forward<Args>(args)...);
+            }
+
+            template <typename Pointer> struct PointerType { };
+
+            /// Allocate an instance whose destruction is reported to the lifetime recorder.
+            template <typename... Args>
+            shared_ptr<Class> allocateObserved(PointerType<shared_ptr<Class> >, const DiFactory& diFactory, Args&&... args)
+            {
+                Class* instance = new Class(std::forward<Args>(args)...);
+                // the lifetime starts once the instance is constructed
+                return shared_ptr<Class>(instance, LifetimeTrackingDeleter<Class>(diFactory._lifetimeRecorder, this->typeId()));
+            }
+
+            template <typename... Args>
+            std::unique_ptr<Class> allocateObserved(PointerType<std::unique_ptr<Class> >, const DiFactory&, Args&&... args)
+            {
+                return std::unique_ptr<Class>(new Class(std::forward<Args>(args)...));
+            }
+
+            /// Hash of the addresses of the dependency instances.
+            template <typename... Args>
+            static uint64_t dependencyIdentity(const Args&... args)
+            {
+                const void* addresses[] = { nullptr, dependencyAddress(args)... };
+                uint64_t identity = 14695981039346656037ull;
+                for (const void* address : addresses){
+                    identity = (identity ^ reinterpret_cast<std::uintptr_t>(address)) * 1099511628211ull;
+                }
+                return identity;
+            }
+
+            template <typename T>
+            static const void* dependencyAddress(const shared_ptr<T>& dependency)
+            {
+                return dependency.get();
+            }
+
+            template <typename T>
+            static const void* dependencyAddress(const std::unique_ptr<T>& dependency)
+            {
+                return dependency.get();
+            }
+
+            template <typename... Args>
+            shared_ptr<Class> allocateUntimed(PointerType<shared_ptr<Class> >, const DiFactory& diFactory, bool longLived, Args&&... args)
+            {
+                if (longLived && diFactory._longLivedRegion){
+                    return allocate_shared<Class>(RegionAllocator<Class>(diFactory._longLivedRegion), std::forward<Args>(args)...);
+                }
+                return make_shared<Class>(std::forward<Args>(args)...);
+            }
+
+            template <typename... Args>
+            std::unique_ptr<Class> allocateUntimed(PointerType<std::unique_ptr<Class> >, const DiFactory&, bool, Args&&... args)
+            {
+                return std::unique_ptr<Class>(new Class(std::forward<Args>(args)...));
+            }
+
         private:
+            /// Storage of a bound argument in a (copyable) std::function.
+            template <typename Arg>
+            struct BoundArgument
+            {
+                using type = Arg;
+                static Arg store(Arg&& arg) { return std::move(arg); }
+                static const Arg& load(const Arg& arg) { return arg; }
+            };
+
+            /// Exclusively owned dependencies are moved into the instance when it is created.
+            template <typename T>
+            struct BoundArgument<std::unique_ptr<T> >
+            {
+                using type = shared_ptr<std::unique_ptr<T> >;
+                static type store(std::unique_ptr<T>&& arg) { return make_shared<std::unique_ptr<T> >(std::move(arg)); }
+                static std::unique_ptr<T> load(const type& arg) { return std::move(*arg); }
+            };
+
+            template <typename... Args>
+            std::function<shared_ptr<Class>()> bindArguments(const DiFactory& diFactory, bool longLived, Args... args)
+            {
+                return bindStored<Args...>(diFactory, longLived, BoundArgument<Args>::store(std::move(args))...);
+            }
+
+            template <typename... Args>
+            std::function<shared_ptr<Class>()> bindStored(const DiFactory& diFactory, bool longLived, typename BoundArgument<Args>::type... stored)
+            {
+                return [this, &diFactory, longLived, stored...]() {
+                    return construct<shared_ptr<Class> >(diFactory, longLived, BoundArgument<Args>::load(stored)...);
+                };
+            }
+
             template <typename T>
-            shared_ptr<T> getDependencyInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
+            typename DependencyType<T>::pointer getDependencyInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
+            {
+                using Type = typename DependencyType<T>::type;
+                AbstractRegistration& dependency = findRegistration<Type>(diFactory);
+                return dependencyInstance<Type>(dependency, diFactory, typeInstanceMap, std::integral_constant<bool, DependencyType<T>::unique>());
+            }
+
+            template <typename T>
+            shared_ptr<T> dependencyInstance(AbstractRegistration& dependency, const DiFactory& diFactory, GenericPtrMap& typeInstanceMap, std::false_type)
             {
-                AbstractRegistration& dependency = findRegistration<T>(diFactory);
                 return dependency.getTypedInstance<T>(diFactory, typeInstanceMap);
             }
 
+            template <typename T>
+            std::unique_ptr<T> dependencyInstance(AbstractRegistration& dependency, const DiFactory& diFactory, GenericPtrMap& typeInstanceMap, std::true_type)
+            {
+                return std::unique_ptr<T>(static_cast<T*>(dependency.createOwned(diFactory, typeInstanceMap)));
+            }
+
             template <typename T>
             bool isDependencyValid(const DiFactory& diFactory, const AbstractRegistration* root, bool& hasSiprDependency) const
             {
-                AbstractRegistration& dependency = findRegistration<T>(diFactory);
+                AbstractRegistration& dependency = findRegistration<typename DependencyType<T>::type>(diFactory);
                 dependency.validate(diFactory, root, hasSiprDependency);
+                if (DependencyType<T>::unique && !dependency.isExclusivelyOwnable(diFactory)){
+                    throw new std::logic_error("Exclusively owned dependency is not registered with registerClass (or its interface has no virtual destructor)");
+                }
                 return true;
             }
 
@@ -516,6 +1856,9 @@ namespace CppDiFactory
             {
                 return call(args...);
             }
+
+            shared_ptr<Executor> _executor;
+            shared_ptr<ConstructionLimiter> _limiter;
        };
 
         /// registration for instance singletons (singleton is kept alive by this object)
@@ -526,19 +1869,81 @@ namespace CppDiFactory
             InstanceRegistration(shared_ptr<Class> instance): _instance(instance) {}
             virtual ~InstanceRegistration(){}
 
+            virtual RegistrationKind kind() const
+            {
+                return RegistrationKind::Instance;
+            }
+
             virtual GenericPtr getInstance(const DiFactory&, GenericPtrMap&)
             {
+                if (!_replicas.empty()){
+                    return _replicas[NumaTopology::instance().cachedCurrentNode()];
+                }
                 return _instance;
             }
 
+            virtual void replicatePerNumaNode()
+            {
+                replicate(std::is_copy_constructible<Class>());
+            }
+
         protected:
             virtual void isValid(const DiFactory&, const AbstractRegistration*, bool&) const
             {
                 //empty;
             }
 
+            virtual void dropCachedInstances(std::vector<GenericPtr>& released)
+            {
+                released.insert(released.end(), _replicas.begin(), _replicas.end());
+                _replicas.clear();
+            }
+
         private:
+            void replicate(std::true_type)
+            {
+                const NumaTopology& topology = NumaTopology::instance();
+                std::vector<shared_ptr<Class> > replicas;
+
+                // nothing to replicate on single node machines
+                if (topology.nodeCount() > 1){
+                    replicas.resize(topology.nodeCount());
+                    for (size_t node = 0; node < replicas.size(); ++node){
+                        topology.runOnNode(node, [&]() {
+                            replicas[node] = make_shared<Class>(*_instance);
+                        });
+                    }
+                }
+                _replicas.swap(replicas);
+            }
+
+            void replicate(std::false_type)
+            {
+                throw new std::logic_error("Replicated instances must be copy constructible");
+            }
+
             shared_ptr<Class> _instance;
+            /// copies of _instance per NUMA node (empty: not replicated)
+            std::vector<shared_ptr<Class> > _replicas;
+        };
+
+        /// registration for the root of a composite (see registerComposite)
+        template <typename CompositeType>
+        class CompositeRegistration: public ClassRegistration<CompositeType>
+        {
+        public:
+            virtual ~CompositeRegistration(){}
+
+            virtual RegistrationKind kind() const
+            {
+                return RegistrationKind::Composite;
+            }
+
+            virtual GenericPtr getInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
+            {
+                shared_ptr<CompositeType> composite = ClassRegistration<CompositeType>::createInstance(diFactory, typeInstanceMap, false);
+                return shared_ptr<typename CompositeType::root_type>(composite, &composite->root());
+            }
         };
 
         /// registration for "weak" singletons (singleton is destroyed when not used any longer)
@@ -546,16 +1951,259 @@ namespace CppDiFactory
         class SingletonRegistration: public ClassRegistration<Class, Dependencies...>
         {
         public:
-            virtual ~SingletonRegistration(){}
+            SingletonRegistration(): _retain(false) {}
+            virtual ~SingletonRegistration(){}
+
+            virtual RegistrationKind kind() const
+            {
+                return RegistrationKind::Singleton;
+            }
+
+            virtual void retain()
+            {
+                _retain = true;
+            }
+
+            virtual GenericPtr getInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
+            {
+                GenericPtr rebuilt = this->rebuiltInstance(diFactory);
+                if (rebuilt){
+                    return rebuilt;
+                }
+
+                shared_ptr<Class> instance = _instance.lock();
+                if (!instance){
+                    const shared_ptr<LifetimeGroup> group = diFactory.lifetimeGroupOf(this->typeId());
+                    // nullptr if the group is being constructed already
+                    const GenericPtr member = group ? diFactory.constructLifetimeGroup(*group, this->typeId()) : nullptr;
+                    if (member){
+                        instance = static_pointer_cast<Class>(member);
+                    } else {
+                        reportExpiry(diFactory);
+                        instance = ClassRegistration<Class, Dependencies...>::createInstance(diFactory, typeInstanceMap, true);
+                        publish(diFactory, instance);
+                    }
+                }
+                if (_retain){
+                    _retained = instance;
+                }
+                return instance;
+            }
+
+            virtual std::function<GenericPtr()> bindWarmUp(const DiFactory& diFactory)
+            {
+                if (!_instance.expired()){
+                    return nullptr;
+                }
+                return bindRebuild(diFactory);
+            }
+
+            virtual bool hasSharedInstance() const
+            {
+                return !_instance.expired();
+            }
+
+            virtual std::function<GenericPtr()> bindRebuild(const DiFactory& diFactory)
+            {
+                GenericPtrMap typeInstanceMap;
+                auto construction = ClassRegistration<Class, Dependencies...>::bindConstruction(diFactory, typeInstanceMap, true);
+                return [construction]() -> GenericPtr { return construction(); };
+            }
+
+            virtual void publishRebuild(const DiFactory& diFactory, const GenericPtr& rebuilt)
+            {
+                const shared_ptr<Class> instance = static_pointer_cast<Class>(rebuilt);
+                publish(diFactory, instance);
+                if (_retained || _retain){
+                    _retained = instance;
+                }
+            }
+
+            virtual void publishGroupMember(const DiFactory& diFactory, const GenericPtr& member)
+            {
+                const shared_ptr<Class> instance = static_pointer_cast<Class>(member);
+                reportExpiry(diFactory);
+                publish(diFactory, instance);
+                if (_retain){
+                    _retained = instance;
+                }
+            }
+
+            virtual void publishWarmUp(const DiFactory& diFactory, const GenericPtr& warmedUp)
+            {
+                shared_ptr<Class> instance = _instance.lock();
+                if (!instance){
+                    reportExpiry(diFactory);
+                    instance = static_pointer_cast<Class>(warmedUp);
+                    publish(diFactory, instance);
+                }
+                _retained = instance;
+            }
+
+        protected:
+            virtual void isValid(const DiFactory& diFactory, const AbstractRegistration* root, bool& hasSiprDependency) const
+            {
+                ClassRegistration<Class, Dependencies...>::isValid(diFactory, root, hasSiprDependency);
+                if (hasSiprDependency){
+                    throw new std::logic_error("Singleton depends on SingleInstancePerRequest class");
+                }
+            }
+
+            virtual void dropCachedInstances(std::vector<GenericPtr>& released)
+            {
+                if (_retained){
+                    released.push_back(_retained);
+                    _retained.reset();
+                }
+            }
+
+        private:
+            void reportExpiry(const DiFactory& diFactory)
+            {
+                // a non-empty but expired weak_ptr still owns a control block
+                if (_instance.owner_before(weak_ptr<Class>()) || weak_ptr<Class>().owner_before(_instance)){
+                    CPPDIFACTORY_PROBE2(singleton_expire, type_id<Class>(), typeid(Class).name());
+                    CPPDIFACTORY_INTERCEPT(diFactory, singletonExpired, *this, nullptr);
+                    if (diFactory._lifetimeRecorder->enabled()){
+                        diFactory._lifetimeRecorder->recordExpiry(this->typeId());
+                    }
+                }
+                (void)diFactory;
+            }
+
+            void publish(const DiFactory& diFactory, const shared_ptr<Class>& instance)
+            {
+                _instance = instance;
+                CPPDIFACTORY_PROBE3(singleton_create, type_id<Class>(), typeid(Class).name(), instance.get());
+                CPPDIFACTORY_INTERCEPT(diFactory, singletonCreated, *this, instance.get());
+                (void)diFactory;
+            }
+
+            weak_ptr<Class> _instance;
+            /// strong reference to _instance (see InterfaceForType::retain and DiFactory::warmUp)
+            shared_ptr<Class> _retained;
+            bool _retain;
+        };
+
+        /// registration for singletons which are rebuilt in the background
+        template <typename Class, typename... Dependencies>
+        class RefreshingRegistration: public ClassRegistration<Class, Dependencies...>
+        {
+        public:
+            RefreshingRegistration(): _periodicRefresh(make_shared<TaskGuard>()) {}
+            virtual ~RefreshingRegistration(){}
+
+            /// Guard of the periodic refresh task (stopped once the registration is retired).
+            shared_ptr<TaskGuard> periodicRefresh() const
+            {
+                return _periodicRefresh;
+            }
+
+            virtual void retire()
+            {
+                _periodicRefresh->stop();
+            }
+
+            virtual RegistrationKind kind() const
+            {
+                return RegistrationKind::Refreshing;
+            }
+
+            virtual GenericPtr getInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
+            {
+                GenericPtr rebuilt = this->rebuiltInstance(diFactory);
+                if (rebuilt){
+                    return rebuilt;
+                }
+
+                shared_ptr<Class> instance = std::atomic_load(&_instance);
+                if (!instance){
+                    instance = ClassRegistration<Class, Dependencies...>::createInstance(diFactory, typeInstanceMap, false);
+                    std::atomic_store(&_instance, instance);
+                }
+                return instance;
+            }
+
+            virtual std::function<GenericPtr()> bindWarmUp(const DiFactory& diFactory)
+            {
+                if (std::atomic_load(&_instance)){
+                    return nullptr;
+                }
+                return bindRebuild(diFactory);
+            }
+
+            virtual bool hasSharedInstance() const
+            {
+                return static_cast<bool>(std::atomic_load(&_instance));
+            }
+
+            virtual std::function<GenericPtr()> bindRebuild(const DiFactory& diFactory)
+            {
+                GenericPtrMap typeInstanceMap;
+                auto construction = ClassRegistration<Class, Dependencies...>::bindConstruction(diFactory, typeInstanceMap, false);
+                return [construction]() -> GenericPtr { return construction(); };
+            }
+
+            virtual void publishRebuild(const DiFactory&, const GenericPtr& rebuilt)
+            {
+                std::atomic_store(&_instance, static_pointer_cast<Class>(rebuilt));
+            }
+
+            virtual void publishWarmUp(const DiFactory&, const GenericPtr& warmedUp)
+            {
+                if (!std::atomic_load(&_instance)){
+                    std::atomic_store(&_instance, static_pointer_cast<Class>(warmedUp));
+                }
+            }
+
+            virtual std::function<void()> prepareRefresh(const DiFactory& diFactory)
+            {
+                GenericPtrMap typeInstanceMap;
+                auto construction = ClassRegistration<Class, Dependencies...>::bindConstruction(diFactory, typeInstanceMap, false);
+                auto self = std::static_pointer_cast<RefreshingRegistration>(this->shared_from_this());
+
+                return [self, construction]() {
+                    std::atomic_store(&self->_instance, construction());
+                };
+            }
+
+        protected:
+            virtual void isValid(const DiFactory& diFactory, const AbstractRegistration* root, bool& hasSiprDependency) const
+            {
+                ClassRegistration<Class, Dependencies...>::isValid(diFactory, root, hasSiprDependency);
+                if (hasSiprDependency){
+                    throw new std::logic_error("Refreshing singleton depends on SingleInstancePerRequest class");
+                }
+            }
+
+        private:
+            shared_ptr<Class> _instance;
+            shared_ptr<TaskGuard> _periodicRefresh;
+        };
+
+        /// registration for instances persisted in (and mapped from) image files
+        template <typename Class, typename... Dependencies>
+        class MappedImageRegistration: public ClassRegistration<Class, Dependencies...>
+        {
+        public:
+            MappedImageRegistration(const std::string& path, uint64_t version): _path(path), _version(version) {}
+            virtual ~MappedImageRegistration(){}
+
+            virtual RegistrationKind kind() const
+            {
+                return RegistrationKind::MappedImage;
+            }
 
             virtual GenericPtr getInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
             {
-                shared_ptr<Class> instance = _instance.lock();
-                if (!instance){
-                    instance  = static_pointer_cast<Class>(ClassRegistration<Class, Dependencies...>::getInstance(diFactory, typeInstanceMap));
-                    _instance = instance;
+                if (!_instance){
+                    _instance = MappedImage::map<Class>(_path, _version);
                 }
-                return instance;
+                if (!_instance){
+                    _instance = ClassRegistration<Class, Dependencies...>::createInstance(diFactory, typeInstanceMap, true);
+                    MappedImage::write(_path, *_instance, _version);
+                }
+                return _instance;
             }
 
         protected:
@@ -563,12 +2211,14 @@ namespace CppDiFactory
             {
                 ClassRegistration<Class, Dependencies...>::isValid(diFactory, root, hasSiprDependency);
                 if (hasSiprDependency){
-                    throw new std::logic_error("Singleton depends on SingleInstancePerRequest class");
+                    throw new std::logic_error("Mapped image depends on SingleInstancePerRequest class");
                 }
             }
 
         private:
-            weak_ptr<Class> _instance;
+            const std::string _path;
+            const uint64_t _version;
+            shared_ptr<Class> _instance;
         };
 
         /// registration for single instance per request classes
@@ -578,10 +2228,19 @@ namespace CppDiFactory
         public:
             virtual ~SingleInstancePerRequestRegistration(){}
 
+            virtual RegistrationKind kind() const
+            {
+                return RegistrationKind::SingleInstancePerRequest;
+            }
+
             virtual GenericPtr getInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
             {
                 auto it = typeInstanceMap.find(type_id<Class>());
-                if (it != typeInstanceMap.end()){
+                const bool reused = it != typeInstanceMap.end();
+                if (diFactory._lifetimeRecorder->enabled()){
+                    diFactory._lifetimeRecorder->recordRequestInstance(this->typeId(), reused);
+                }
+                if (reused){
                     return it->second;
                 } else {
                     GenericPtr instance  = ClassRegistration<Class, Dependencies...>::getInstance(diFactory, typeInstanceMap);
@@ -610,6 +2269,11 @@ namespace CppDiFactory
         public:
             virtual ~InstanceProvidedAtRequestRegistration(){}
 
+            virtual RegistrationKind kind() const
+            {
+                return RegistrationKind::InstanceProvidedAtRequest;
+            }
+
             virtual GenericPtr getInstance(const DiFactory& diFactory, GenericPtrMap& typeInstanceMap)
             {
                 auto it = typeInstanceMap.find(type_id<Class>());
@@ -632,10 +2296,633 @@ namespace CppDiFactory
             }
         };
 
+        void invalidateAll()
+        {
+            for (auto itr : _registeredTypes){
+                itr.second->invalidate();
+            }
+            _reachabilityValid = false;
+            _captivesValid = false;
+            _validationCacheState = ValidationCacheState::Unchecked;
+        }
+
+        void validateAll()
+        {
+            if (!loadValidationCache()){
+                for (auto it: _registeredTypes){
+                    it.second->validate(*this);
+                }
+
+                buildReachabilityIndex();
+                storeValidationCache();
+            }
+
+            checkCaptiveDependencies();
+        }
+
+        void buildReachabilityIndex()
+        {
+            if (!_reachabilityValid){
+                std::vector<size_t> nodes;
+                std::vector<std::vector<size_t> > dependencies;
+                nodes.reserve(_registeredTypes.size());
+                dependencies.reserve(_registeredTypes.size());
+                for (auto it: _registeredTypes){
+                    nodes.push_back(it.first);
+                    dependencies.push_back(it.second->dependencies());
+                }
+                _reachability.build(nodes, dependencies);
+                _reachabilityValid = true;
+            }
+        }
+
+        /// Combine the stable hashes of all registrations (computed once per
+        /// change of the registrations).
+        uint64_t computeFingerprint()
+        {
+            if (_fingerprintGeneration != _registrationGeneration){
+                uint64_t sum = 0;
+                for (auto it: _registeredTypes){
+                    sum += RegistryFingerprint::mix(it.second->stableHash());
+                }
+                RegistryFingerprint fingerprint;
+                fingerprint.add(static_cast<uint64_t>(_registeredTypes.size()));
+                fingerprint.add(sum);
+                _fingerprint = fingerprint.value();
+                _fingerprintGeneration = _registrationGeneration;
+            }
+            return _fingerprint;
+        }
+
+        /// Mark all types as validated if the validation cache matches the registrations.
+        /// \return true if the cached results are used
+        bool loadValidationCache()
+        {
+            if (_validationCachePath.empty() || _validationCacheState != ValidationCacheState::Unchecked){
+                return _validationCacheState == ValidationCacheState::Loaded;
+            }
+
+            _validationCacheState = ValidationCacheState::Missed;
+            std::vector<ValidationCacheEntry> entries;
+            if (!ValidationCache::load(_validationCachePath, computeFingerprint(), entries) ||
+                entries.size() != _registeredTypes.size()){
+                return false;
+            }
+
+            unordered_map<std::string, AbstractRegistration*> byName;
+            for (auto it: _registeredTypes){
+                byName[it.second->typeInfo().name()] = it.second.get();
+            }
+            for (const ValidationCacheEntry& entry : entries){
+                if (byName.find(entry.type) == byName.end()){
+                    return false;
+                }
+            }
+
+            for (const ValidationCacheEntry& entry : entries){
+                byName[entry.type]->markValidated(entry.hasSiprDependency);
+            }
+            _validationCacheState = ValidationCacheState::Loaded;
+            return true;
+        }
+
+        /// Write the validation results of all types (after a successful validation).
+        void storeValidationCache()
+        {
+            if (_validationCachePath.empty() || _validationCacheState != ValidationCacheState::Missed){
+                return;
+            }
+
+            std::vector<ValidationCacheEntry> entries;
+            entries.reserve(_registeredTypes.size());
+            for (auto it: _registeredTypes){
+                entries.push_back(ValidationCacheEntry{ it.second->typeInfo().name(), it.second->hasSiprDependency() });
+            }
+            ValidationCache::store(_validationCachePath, computeFingerprint(), entries);
+            _validationCacheState = ValidationCacheState::Stored;
+        }
+
+        /// Apply the captive dependency policy (once per change of the registrations).
+        void checkCaptiveDependencies()
+        {
+            if (_captivesValid || _captivePolicy == CaptiveDependencyPolicy::Ignore){
+                return;
+            }
+
+            const std::vector<CaptiveDependency> captives = findCaptiveDependencies();
+            if (!captives.empty() && _captivePolicy == CaptiveDependencyPolicy::Reject){
+                throw new std::logic_error("captive dependency: " + captives.front().describe());
+            }
+            _captivesValid = true;
+            if (_captiveReporter){
+                for (const CaptiveDependency& captive : captives){
+                    _captiveReporter(captive);
+                }
+            }
+        }
+
+        std::vector<CaptiveDependency> findCaptiveDependencies() const
+        {
+            std::vector<CaptiveDependency> captives;
+            for (auto it: _registeredTypes){
+                const RegistrationKind kind = it.second->kind();
+                // instances of mapped images are trivially copyable and can not keep other instances alive
+                if (kind == RegistrationKind::Interface || kind == RegistrationKind::MappedImage ||
+                    lifetimeOf(kind) == Lifetime::Transient){
+                    continue;
+                }
+
+                CaptiveDependency captive{ it.first, 0, lifetimeOf(kind), Lifetime::Transient,
+                                           std::vector<std::string>{ it.second->typeName() } };
+                std::unordered_set<size_t> visited{ it.first };
+                findCaptives(*it.second, captive, visited, captives);
+            }
+            return captives;
+        }
+
+        /// Follow the dependencies of registration (through interfaces) to the first
+        /// types with a shorter lifetime than the holder of captive.
+        void findCaptives(const AbstractRegistration& registration, CaptiveDependency& captive,
+                          std::unordered_set<size_t>& visited, std::vector<CaptiveDependency>& captives) const
+        {
+            for (size_t dependency : registration.dependencies()){
+                const auto it = _registeredTypes.find(dependency);
+                if (it == _registeredTypes.end() || !visited.insert(dependency).second){
+                    continue;
+                }
+
+                captive.path.push_back(it->second->typeName());
+                const RegistrationKind kind = it->second->kind();
+                if (kind == RegistrationKind::Interface){
+                    findCaptives(*it->second, captive, visited, captives);
+                } else if (lifetimeOf(kind) < captive.holderLifetime){
+                    CaptiveDependency found = captive;
+                    found.captive = dependency;
+                    found.captiveLifetime = lifetimeOf(kind);
+                    captives.push_back(found);
+                }
+                captive.path.pop_back();
+            }
+        }
+
+        /// Get the reachability index (validates all types if it is outdated).
+        const ReachabilityIndex& reachabilityIndex()
+        {
+            if (!_reachabilityValid){
+                validateAll();
+                buildReachabilityIndex();
+            }
+            return _reachability;
+        }
+
+        void refreshRegistration(size_t typeId)
+        {
+            std::function<void()> rebuild;
+            {
+                lock_guard<mutex_type> lockGuard{ _mutex };
+
+                AbstractRegistration& registration = findRegistration(typeId);
+                registration.validate(*this);
+                rebuild = limited(registration, registration.prepareRefresh(*this));
+            }
+            rebuild();
+        }
+
+        void scheduleRefresh(size_t typeId, shared_ptr<TaskGuard> registrationGuard, std::chrono::steady_clock::duration interval, shared_ptr<Executor> executor)
+        {
+            shared_ptr<TaskGuard> guard = _backgroundTasks;
+            std::function<void()> task = [this, guard, registrationGuard, typeId]() {
+                if (!guard->enter()){
+                    return;
+                }
+                if (registrationGuard->enter()){
+                    try {
+                        refreshRegistration(typeId);
+                    } catch (std::logic_error* e) {
+                        // keep the current instance
+                        delete e;
+                    } catch (...) {
+                        // keep the current instance
+                    }
+                    registrationGuard->leave();
+                }
+                guard->leave();
+            };
+
+            _scheduler.schedule(typeId, interval, [this, executor, task]() {
+                (executor ? executor : this->executor())->execute(task);
+            });
+        }
+
+        /// Stop the background work of a registration which is unregistered or replaced.
+        void retireRegistration(AbstractRegistration& registration)
+        {
+            registration.retire();
+            _scheduler.cancel(registration.typeId());
+        }
+
+        /// Create the shared instances used by the supplied types, level by level.
+        size_t warmUpTypes(const std::vector<size_t>& typeIds, std::vector<std::string>* failedTypes)
+        {
+            std::vector<std::vector<size_t> > levels;
+            {
+                lock_guard<mutex_type> lockGuard{ _mutex };
+
+                const ReachabilityIndex& index = reachabilityIndex();
+                std::unordered_set<size_t> selected;
+                for (size_t typeId : typeIds){
+                    if (index.contains(typeId)){
+                        selected.insert(typeId);
+                        for (size_t dependency : index.dependenciesOf(typeId)){
+                            selected.insert(dependency);
+                        }
+                    }
+                }
+                levels = dependencyLevels(selected);
+            }
+
+            size_t created = 0;
+            for (const std::vector<size_t>& level : levels){
+                created += warmUpLevel(level, failedTypes);
+            }
+            return created;
+        }
+
+        /// Group the selected types by the length of the longest dependency chain
+        /// below them (within the selection), so the types of a level only depend on
+        /// types of lower levels (the reachability index must be valid).
+        std::vector<std::vector<size_t> > dependencyLevels(const std::unordered_set<size_t>& selected) const
+        {
+            std::vector<std::vector<size_t> > levels;
+            unordered_map<size_t, size_t> levelOf;
+            for (size_t typeId : _reachability.topologicalOrder()){
+                if (selected.count(typeId)){
+                    size_t level = 0;
+                    for (size_t dependency : _reachability.dependenciesOf(typeId)){
+                        const auto it = levelOf.find(dependency);
+                        if (it != levelOf.end()){
+                            level = std::max(level, it->second + 1);
+                        }
+                    }
+                    levelOf[typeId] = level;
+                    if (levels.size() <= level){
+                        levels.resize(level + 1);
+                    }
+                    levels[level].push_back(typeId);
+                }
+            }
+            return levels;
+        }
+
+        /// Singletons sharing a single lifetime (see registerLifetimeGroup).
+        struct LifetimeGroup
+        {
+            LifetimeGroup(): constructing(false) {}
+
+            std::vector<size_t> members;
+            shared_ptr<Executor> executor;
+            bool constructing;
+        };
+
+        shared_ptr<LifetimeGroup> lifetimeGroupOf(size_t typeId) const
+        {
+            const auto it = _lifetimeGroups.find(typeId);
+            return it != _lifetimeGroups.end() ? it->second : nullptr;
+        }
+
+        /// Construct and publish the expired members of a lifetime group (the factory
+        /// is locked). The members are kept alive by a single holder and published
+        /// as aliases of it; within the group they use each other directly, so the
+        /// holder is not kept alive by its own members.
+        /// \return instance of the requested member, nullptr if the group is being constructed
+        GenericPtr constructLifetimeGroup(LifetimeGroup& group, size_t requested) const
+        {
+            if (group.constructing){
+                return nullptr;
+            }
+            struct Constructing
+            {
+                ~Constructing() { group.constructing = false; }
+                LifetimeGroup& group;
+            } constructing{ group };
+            group.constructing = true;
+
+            std::unordered_set<size_t> expired;
+            for (size_t member : group.members){
+                const auto it = _registeredTypes.find(member);
+                if (it != _registeredTypes.end() && !it->second->hasSharedInstance()){
+                    expired.insert(member);
+                }
+            }
+
+            // dependencies constructed on lower levels are taken from the group
+            GenericPtrMap constructed;
+            struct Staging
+            {
+                ~Staging() { diFactory._rebuiltInstances = previous; }
+                const DiFactory& diFactory;
+                const GenericPtrMap* previous;
+            } staging{ *this, _rebuiltInstances };
+            _rebuiltInstances = &constructed;
+
+            for (const std::vector<size_t>& level : groupLevels(expired)){
+                std::vector<std::function<GenericPtr()> > constructions;
+                for (size_t typeId : level){
+                    constructions.push_back(findRegistration(typeId).bindRebuild(*this));
+                }
+                if (group.executor){
+                    // like constructOn, the executor does not wait for the factory
+                    const std::vector<GenericPtr> instances = waitForConstructions(runConstructions(constructions, group.executor));
+                    for (size_t i = 0; i < level.size(); ++i){
+                        constructed[level[i]] = instances[i];
+                    }
+                } else {
+                    for (size_t i = 0; i < level.size(); ++i){
+                        constructed[level[i]] = constructions[i]();
+                    }
+                }
+            }
+
+            auto holder = make_shared<std::vector<GenericPtr> >();
+            for (auto it : constructed){
+                holder->push_back(it.second);
+            }
+            GenericPtr result;
+            for (auto it : constructed){
+                const GenericPtr member(holder, it.second.get());
+                findRegistration(it.first).publishGroupMember(*this, member);
+                if (it.first == requested){
+                    result = member;
+                }
+            }
+            return result;
+        }
+
+        /// Dependency levels of the selected types, considering indirect
+        /// dependencies through types which are not selected.
+        std::vector<std::vector<size_t> > groupLevels(const std::unordered_set<size_t>& selected) const
+        {
+            std::vector<std::vector<size_t> > levels;
+            unordered_map<size_t, int> below;
+            for (size_t typeId : selected){
+                const size_t level = static_cast<size_t>(levelBelow(typeId, selected, below) + 1);
+                if (levels.size() <= level){
+                    levels.resize(level + 1);
+                }
+                levels[level].push_back(typeId);
+            }
+            return levels;
+        }
+
+        /// Highest level of a selected type typeId depends on (-1: none).
+        int levelBelow(size_t typeId, const std::unordered_set<size_t>& selected, unordered_map<size_t, int>& below) const
+        {
+            const auto known = below.find(typeId);
+            if (known != below.end()){
+                return known->second;
+            }
+            int level = -1;
+            const auto it = _registeredTypes.find(typeId);
+            if (it != _registeredTypes.end()){
+                for (size_t dependency : it->second->dependencies()){
+                    const int dependencyBelow = levelBelow(dependency, selected, below);
+                    level = std::max(level, selected.count(dependency) ? dependencyBelow + 1 : dependencyBelow);
+                }
+            }
+            below[typeId] = level;
+            return level;
+        }
+
+        /// Apply the construction limiter of a registration (see maxConcurrentConstructions)
+        /// to a construction which runs without the factory being locked.
+        template <typename Result>
+        static std::function<Result()> limited(const AbstractRegistration& registration, std::function<Result()> construction)
+        {
+            const shared_ptr<ConstructionLimiter> limiter = registration.constructionLimiter();
+            if (!limiter || !construction){
+                return construction;
+            }
+            return [limiter, construction]() -> Result {
+                if (!limiter->acquire()){
+                    throw new std::logic_error("Timeout waiting for construction");
+                }
+                struct Release
+                {
+                    ~Release() { limiter.release(); }
+                    ConstructionLimiter& limiter;
+                } release{ *limiter };
+
+                return construction();
+            };
+        }
+
+        /// Run independent constructions in parallel on the executor
+        /// (the factory must not be locked).
+        std::vector<std::future<GenericPtr> > runConstructions(const std::vector<std::function<GenericPtr()> >& constructions,
+                                                                const shared_ptr<Executor>& executor) const
+        {
+            std::vector<std::future<GenericPtr> > instances;
+            for (const std::function<GenericPtr()>& construction : constructions){
+                auto task = make_shared<std::packaged_task<GenericPtr()> >(construction);
+                instances.push_back(task->get_future());
+                if (constructions.size() > 1 && !executor->runsInCurrentThread()){
+                    executor->execute([task]() { (*task)(); });
+                } else {
+                    (*task)();
+                }
+            }
+            return instances;
+        }
+
+        /// Wait until all constructions have finished (they use the registrations
+        /// and arguments of the caller), then get the instances.
+        /// Rethrows the exception of the first failed construction.
+        static std::vector<GenericPtr> waitForConstructions(std::vector<std::future<GenericPtr> > futures)
+        {
+            for (std::future<GenericPtr>& future : futures){
+                future.wait();
+            }
+            std::vector<GenericPtr> instances;
+            for (std::future<GenericPtr>& future : futures){
+                instances.push_back(future.get());
+            }
+            return instances;
+        }
+
+        /// Create the shared instances of independent types in parallel.
+        size_t warmUpLevel(const std::vector<size_t>& typeIds, std::vector<std::string>* failedTypes)
+        {
+            std::vector<shared_ptr<AbstractRegistration> > registrations;
+            std::vector<std::function<GenericPtr()> > constructions;
+            shared_ptr<Executor> executor;
+            {
+                lock_guard<mutex_type> lockGuard{ _mutex };
+
+                for (size_t typeId : typeIds){
+                    const auto it = _registeredTypes.find(typeId);
+                    if (it == _registeredTypes.end()){
+                        continue;
+                    }
+                    try {
+                        std::function<GenericPtr()> construct = it->second->bindWarmUp(*this);
+                        if (construct){
+                            registrations.push_back(it->second);
+                            constructions.push_back(limited(*it->second, construct));
+                        }
+                    } catch (std::logic_error* e) {
+                        // can not be created ahead of a request
+                        delete e;
+                    } catch (...) {
+                        reportFailedWarmUp(*it->second, failedTypes);
+                    }
+                }
+                executor = factoryExecutor();
+            }
+
+            // the constructions do not use the factory, so they run without it being locked
+            std::vector<std::future<GenericPtr> > results = runConstructions(constructions, executor);
+
+            std::vector<std::pair<shared_ptr<AbstractRegistration>, GenericPtr> > instances;
+            for (size_t i = 0; i < results.size(); ++i){
+                try {
+                    instances.push_back(std::make_pair(registrations[i], results[i].get()));
+                } catch (std::logic_error* e) {
+                    delete e;
+                    reportFailedWarmUp(*registrations[i], failedTypes);
+                } catch (...) {
+                    reportFailedWarmUp(*registrations[i], failedTypes);
+                }
+            }
+
+            lock_guard<mutex_type> lockGuard{ _mutex };
+            for (auto& instance : instances){
+                instance.first->publishWarmUp(*this, instance.second);
+            }
+            return instances.size();
+        }
+
+        static void reportFailedWarmUp(const AbstractRegistration& registration, std::vector<std::string>* failedTypes)
+        {
+            if (failedTypes){
+                failedTypes->push_back(registration.typeName());
+            }
+        }
+
+        /// Check if rebuildAffected replaces the instances of a registration.
+        static bool isRebuildable(const AbstractRegistration& registration)
+        {
+            return registration.kind() == RegistrationKind::Singleton || registration.kind() == RegistrationKind::Refreshing;
+        }
+
+        /// Get the executor of the factory (the factory must be locked).
+        shared_ptr<Executor> factoryExecutor()
+        {
+            if (!_executor){
+                _executor = make_shared<WorkStealingExecutor>();
+            }
+            return _executor;
+        }
+
+        /// Instances of the request scope of this factory active on the current thread
+        /// (the supplied instances if there is none).
+        GenericPtrMap& activeScopeInstances(GenericPtrMap& instances)
+        {
+            const RequestScope& scope = RequestScope::current();
+            if (scope && &scope._state->factory == this){
+                return scope._state->instances;
+            }
+            return instances;
+        }
+
+        /// Instances of a request scope of this factory.
+        GenericPtrMap& scopeInstances(const RequestScope& scope)
+        {
+            if (!scope || &scope._state->factory != this){
+                throw new std::logic_error("Request scope of another factory");
+            }
+            return scope._state->instances;
+        }
+
+        /// Validate and resolve the registration of T (the factory must be locked).
+        template <typename T>
+        shared_ptr<T> resolve(GenericPtrMap& typeInstanceMap)
+        {
+            AbstractRegistration& registration = findRegistration<T>();
+            loadValidationCache();
+            registration.validate(*this);
+            checkCaptiveDependencies();
+            if (_recordUsage){
+                _usedTypes.insert(type_id<T>());
+            }
+
+#if !defined(CPPDIFACTORY_NO_INTERCEPTORS)
+            if (_interceptor.load(std::memory_order_acquire)){
+                return resolveIntercepted<T>(registration, typeInstanceMap);
+            }
+#endif
+            return registration.getTypedInstance<T>(*this, typeInstanceMap);
+        }
+
+#if !defined(CPPDIFACTORY_NO_INTERCEPTORS)
+        /// Resolve T as a new request reported to the interceptor.
+        template <typename T>
+        shared_ptr<T> resolveIntercepted(AbstractRegistration& registration, GenericPtrMap& typeInstanceMap)
+        {
+            struct Request
+            {
+                Request(const DiFactory& diFactory, const AbstractRegistration& registration):
+                    diFactory(diFactory), registration(registration), previousId(currentRequestId()), instance(nullptr)
+                {
+                    currentRequestId() = diFactory._requestCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+                    CPPDIFACTORY_INTERCEPT(diFactory, requestBegin, registration, nullptr);
+                }
+
+                ~Request()
+                {
+                    CPPDIFACTORY_INTERCEPT(diFactory, requestEnd, registration, instance);
+                    currentRequestId() = previousId;
+                }
+
+                const DiFactory& diFactory;
+                const AbstractRegistration& registration;
+                const uint64_t previousId;
+                const void* instance;
+            } request(*this, registration);
+
+            shared_ptr<T> instance = registration.getTypedInstance<T>(*this, typeInstanceMap);
+            request.instance = instance.get();
+            return instance;
+        }
+
+        /// Call a hook of the interceptor (if any).
+        void intercept(void (ConstructionInterceptor::*hook)(const InterceptionEvent&),
+                       const AbstractRegistration& registration, const void* instance) const
+        {
+            ConstructionInterceptor* interceptor = _interceptor.load(std::memory_order_acquire);
+            if (interceptor){
+                (interceptor->*hook)(InterceptionEvent{ registration.typeId(), &registration.typeInfo(), registration.kind(),
+                                                        currentRequestId(), std::chrono::steady_clock::now(), instance });
+            }
+        }
+#endif
+
         template<typename T>
         AbstractRegistration& findRegistration() const
         {
-            const auto it = _registeredTypes.find(type_id<T>());
+            return findRegistration(type_id<T>());
+        }
+
+        AbstractRegistration& findRegistration(size_t typeId) const
+        {
+            if (_frozenRegistry.built()){
+                AbstractRegistration* registration = _frozenRegistry.find(typeId);
+                if (!registration){
+                    throw new std::logic_error("type not registered");
+                }
+                return *registration;
+            }
+
+            const auto it = _registeredTypes.find(typeId);
             if (it != _registeredTypes.end()){
                 return *it->second.get();
             } else {
@@ -643,18 +2930,77 @@ namespace CppDiFactory
             }
         }
 
+        /// Type id of the class implementing an interface (the type id itself for other types).
+        size_t implementingType(size_t typeId) const
+        {
+            auto it = _registeredTypes.find(typeId);
+            while (it != _registeredTypes.end() && it->second->kind() == RegistrationKind::Interface){
+                const std::vector<size_t> dependencies = it->second->dependencies();
+                typeId = dependencies.front();
+                it = _registeredTypes.find(typeId);
+            }
+            return typeId;
+        }
+
+        void checkNotFrozen() const
+        {
+            if (_frozenRegistry.built()){
+                throw new std::logic_error("Registry is frozen");
+            }
+        }
+
         template <typename T>
-        void addRegistration(shared_ptr<AbstractRegistration> registration)
+        InterfaceForType<T> addRegistrationSynchronized(shared_ptr<AbstractRegistration> registration)
         {
+            synchronized([&]() {
+                addRegistration<T>(registration);
+            });
+            return InterfaceForType<T>(*this, registration);
+        }
+
+        /// Run function with the factory locked. With flat combining (compile
+        /// with CPPDIFACTORY_FLAT_COMBINING), it may run on the thread currently
+        /// holding the lock, so it must not use thread locals (e.g. the active
+        /// request scope). Requests are not combined once types (or lifetime
+        /// groups) are constructed on executors, as the waiting thread may be
+        /// needed by the executor, nor once requests depend on their thread
+        /// (NUMA replicas, interceptors).
+        template <typename Function>
+        void synchronized(Function function)
+        {
+            if (_constructionExecutors || _threadDependentRequests){
+                lock_guard<mutex_type> lockGuard{ _mutex };
+                function();
+                return;
+            }
+            runLocked(_mutex, function);
+        }
+
+        template <typename T>
+        InterfaceForType<T> addRegistration(shared_ptr<AbstractRegistration> registration)
+        {
+            CPPDIFACTORY_PROBE2(register_type, type_id<T>(), typeid(T).name());
+            checkNotFrozen();
+            if (_lifetimeGroups.count(type_id<T>()) && registration->kind() != RegistrationKind::Singleton){
+                throw new std::logic_error("Lifetime group member is not registered with registerSingleton");
+            }
+
+            registration->setType(type_id<T>(), typeid(T));
             auto result = _registeredTypes.insert(std::make_pair(type_id<T>(), registration));
 
             if (!result.second){
+                retireRegistration(*result.first->second);
                 result.first->second = registration;
+                _changedTypes.insert(type_id<T>());
 
-                for (auto itr : _registeredTypes){
-                    itr.second->invalidate();
-                }
+                invalidateAll();
             }
+            ++_registrationGeneration;
+            _reachabilityValid = false;
+            _captivesValid = false;
+            _validationCacheState = ValidationCacheState::Unchecked;
+
+            return InterfaceForType<T>(*this, registration);
         }
 
         template <typename Instance, typename... Instances>
@@ -679,9 +3025,72 @@ namespace CppDiFactory
 
         /// Holds the registration object for the registered types
         unordered_map<size_t, shared_ptr<AbstractRegistration> > _registeredTypes;
+        /// Lookup tables of the registrations once frozen (see freeze)
+        FrozenRegistry<AbstractRegistration> _frozenRegistry;
+        /// Region for long-lived instances (see useLongLivedRegion)
+        shared_ptr<LongLivedRegion> _longLivedRegion;
+        /// Transitive dependencies of all registered types (built by validateAll)
+        ReachabilityIndex _reachability;
+        bool _reachabilityValid = false;
+        /// Handling of captive dependencies (see setCaptiveDependencyPolicy)
+        CaptiveDependencyPolicy _captivePolicy = CaptiveDependencyPolicy::Report;
+        std::function<void(const CaptiveDependency&)> _captiveReporter;
+        bool _captivesValid = false;
+        /// Validation results file (see setValidationCache)
+        enum class ValidationCacheState { Unchecked, Loaded, Missed, Stored };
+        std::string _validationCachePath;
+        ValidationCacheState _validationCacheState = ValidationCacheState::Unchecked;
+        /// Background tasks working on this factory and their timer thread
+        shared_ptr<TaskGuard> _backgroundTasks = make_shared<TaskGuard>();
+        PeriodicScheduler _scheduler;
+        /// Executor for background work (see setExecutor)
+        shared_ptr<Executor> _executor;
+        /// Requests per call site (see enableCallSiteStatistics)
+        CallSiteRecorder _callSites;
+        /// Construction times per type (see enableConstructionTiming),
+        /// recorded by the registrations which only get a const factory
+        mutable ConstructionTimer _constructionTimer;
+        /// Observed instances per type (see enableLifetimeAdvisor), kept alive by tracked instances
+        shared_ptr<LifetimeRecorder> _lifetimeRecorder = make_shared<LifetimeRecorder>();
+        /// Types requested while recording (see recordUsage)
+        bool _recordUsage = false;
+        std::unordered_set<size_t> _usedTypes;
+        /// Types registered again since the last rebuild (see rebuildAffected),
+        /// incremented on every registration change and the instances rebuilt so far
+        std::unordered_set<size_t> _changedTypes;
+        uint64_t _registrationGeneration = 0;
+        /// fingerprint of the registrations, valid for _fingerprintGeneration
+        uint64_t _fingerprint = 0;
+        uint64_t _fingerprintGeneration = ~uint64_t(0);
+        mutable const GenericPtrMap* _rebuiltInstances = nullptr;
+        /// Lifetime group of each member (see registerLifetimeGroup)
+        unordered_map<size_t, shared_ptr<LifetimeGroup> > _lifetimeGroups;
+#if !defined(CPPDIFACTORY_NO_INTERCEPTORS)
+        /// Current interceptor (see setInterceptor) and all interceptors ever installed
+        std::atomic<ConstructionInterceptor*> _interceptor{ nullptr };
+        std::vector<shared_ptr<ConstructionInterceptor> > _interceptors;
+        mutable std::atomic<uint64_t> _requestCounter{ 0 };
+#endif
+        /// Calls onMemoryPressure on memory stalls (see watchMemoryPressure)
+        MemoryPressureWatcher _memoryPressureWatcher;
         mutex_type _mutex;
+        /// some types are constructed on executors (see InterfaceForType::constructOn, registerLifetimeGroup)
+        std::atomic<bool> _constructionExecutors{ false };
+        /// requests use thread locals: NUMA replicas (of instances or of the frozen
+        /// registry, see NumaTopology::cachedCurrentNode) or interceptors (hooks and
+        /// currentRequestId)
+        std::atomic<bool> _threadDependentRequests{ false };
 
     };
+
+    template <typename T>
+    std::shared_ptr<T> RequestScope::getInstance() const
+    {
+        if (!_state){
+            throw new std::logic_error("No request scope");
+        }
+        return _state->factory.getInstance<T>(*this);
+    }
 } // namespace CppDiFactory
 
 #endif // CPP_DI_FACTORY_H
@@ -0,0 +1,51 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <functional>
+
+namespace CppDiFactory
+{
+    /// Interface for executors used by the DiFactory to run work on
+    /// specific threads (e.g. an event loop or a thread pool).
+    /// Applications can adapt their own executors by implementing this interface.
+    class Executor
+    {
+    public:
+        virtual ~Executor() = default;
+
+        /// Schedule the task for execution on this executor.
+        virtual void execute(std::function<void()> task) = 0;
+
+        /// Check if the calling thread belongs to this executor.
+        /// The DiFactory runs tasks directly instead of waiting for them
+        /// if they are requested from a thread of the executor itself.
+        virtual bool runsInCurrentThread() const
+        {
+            return false;
+        }
+    };
+
+    /// Adapter for executors which provide a function for scheduling tasks.
+    /// \code
+    ///   auto executor = std::make_shared<ExecutorAdapter>([&ioContext](std::function<void()> task) {
+    ///       ioContext.post(task);
+    ///   });
+    /// \endcode
+    class ExecutorAdapter: public Executor
+    {
+    public:
+        using Schedule = std::function<void(std::function<void()>)>;
+
+        ExecutorAdapter(Schedule schedule): _schedule(schedule) {}
+
+        virtual void execute(std::function<void()> task) override
+        {
+            _schedule(task);
+        }
+
+    private:
+        Schedule _schedule;
+    };
+} // namespace CppDiFactory
+
+#endif // EXECUTOR_H
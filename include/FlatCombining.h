@@ -0,0 +1,199 @@
+#ifndef FLATCOMBINING_H
+#define FLATCOMBINING_H
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace CppDiFactory
+{
+    /// Mutex with flat combining.
+    /// Instead of handing the lock (and the data it protects) from thread to
+    /// thread, contending threads publish their critical sections in a slot
+    /// (see run) and the thread holding the lock executes all published
+    /// sections in one go before releasing it.
+    /// Waiting threads spin on their own slot and only try to take the lock
+    /// when it is free (test-and-test-and-set), so they do not contend for
+    /// the mutex while a combiner is active.
+    /// lock and unlock can still be used directly (e.g. by lock_guard);
+    /// unlock executes the published sections as well.
+    /// \tparam Mutex  mutex protecting the data
+    /// \tparam Slots  number of publication slots (threads sharing a slot
+    ///                fall back to locking the mutex)
+    template <typename Mutex, size_t Slots = 64>
+    class FlatCombiningMutex
+    {
+    public:
+        FlatCombiningMutex(): _held(false), _storage(new char[sizeof(Slot) * Slots + alignof(Slot)]), _slots(nullptr)
+        {
+            // allocated separately, new does not respect the alignment of Slot before C++17
+            void* storage = _storage.get();
+            size_t space = sizeof(Slot) * Slots + alignof(Slot);
+            _slots = static_cast<Slot*>(std::align(alignof(Slot), sizeof(Slot) * Slots, storage, space));
+            for (size_t i = 0; i < Slots; ++i){
+                new (&_slots[i]) Slot();
+                _slots[i].state.store(Free, std::memory_order_relaxed);
+            }
+        }
+
+        ~FlatCombiningMutex()
+        {
+            for (size_t i = 0; i < Slots; ++i){
+                _slots[i].~Slot();
+            }
+        }
+
+        FlatCombiningMutex(const FlatCombiningMutex&) = delete;
+        FlatCombiningMutex& operator=(const FlatCombiningMutex&) = delete;
+
+        void lock()
+        {
+            _mutex.lock();
+            _held.store(true, std::memory_order_relaxed);
+        }
+
+        bool try_lock()
+        {
+            if (!_mutex.try_lock()){
+                return false;
+            }
+            _held.store(true, std::memory_order_relaxed);
+            return true;
+        }
+
+        void unlock()
+        {
+            combine();
+            _held.store(false, std::memory_order_relaxed);
+            _mutex.unlock();
+        }
+
+        /// Run function while the mutex is locked, either on the calling thread
+        /// or on the thread holding the lock. Exceptions are rethrown on the
+        /// calling thread.
+        /// \note function must not depend on the thread it runs on (thread
+        ///       locals, waiting for work queued to the calling thread).
+        template <typename Function>
+        void run(Function& function)
+        {
+            if (try_lock()){
+                std::lock_guard<FlatCombiningMutex> lockGuard{ *this, std::adopt_lock };
+                function();
+                return;
+            }
+
+            Slot* slot = claimSlot();
+            if (!slot){
+                std::lock_guard<FlatCombiningMutex> lockGuard{ *this };
+                function();
+                return;
+            }
+
+            slot->invoke = &invoke<Function>;
+            slot->function = &function;
+            slot->state.store(Pending, std::memory_order_release);
+            while (!waitForCompletion(*slot)){
+                if (!_held.load(std::memory_order_relaxed) && try_lock()){
+                    // executes the published sections, including our own
+                    unlock();
+                }
+            }
+
+            std::exception_ptr error = slot->error;
+            slot->error = nullptr;
+            slot->state.store(Free, std::memory_order_release);
+            if (error){
+                std::rethrow_exception(error);
+            }
+        }
+
+    private:
+        enum State { Free, Claimed, Pending, Done };
+
+        /// one slot per cache line, publishing threads do not disturb each other
+        struct alignas(64) Slot
+        {
+            std::atomic<int> state;
+            void (*invoke)(void*);
+            void* function;
+            std::exception_ptr error;
+        };
+
+        /// Spin on the own slot for a while.
+        /// \return true if the section has been executed
+        static bool waitForCompletion(const Slot& slot)
+        {
+            for (int spin = 0; spin < 256; ++spin){
+                if (slot.state.load(std::memory_order_acquire) == Done){
+                    return true;
+                }
+            }
+            std::this_thread::yield();
+            return slot.state.load(std::memory_order_acquire) == Done;
+        }
+
+        template <typename Function>
+        static void invoke(void* function)
+        {
+            (*static_cast<Function*>(function))();
+        }
+
+        Slot* claimSlot()
+        {
+            static std::atomic<size_t> nextSlot(0);
+            static thread_local size_t ownSlot = nextSlot++;
+
+            Slot& slot = _slots[ownSlot % Slots];
+            int expected = Free;
+            if (!slot.state.compare_exchange_strong(expected, Claimed, std::memory_order_acquire)){
+                return nullptr;
+            }
+            return &slot;
+        }
+
+        /// Execute the published sections (the mutex must be locked).
+        void combine()
+        {
+            for (size_t i = 0; i < Slots; ++i){
+                Slot& slot = _slots[i];
+                if (slot.state.load(std::memory_order_acquire) != Pending){
+                    continue;
+                }
+                try {
+                    slot.invoke(slot.function);
+                } catch (...) {
+                    slot.error = std::current_exception();
+                }
+                slot.state.store(Done, std::memory_order_release);
+            }
+        }
+
+        Mutex _mutex;
+        /// the mutex is locked (read by waiting threads before trying to lock it)
+        std::atomic<bool> _held;
+        std::unique_ptr<char[]> _storage;
+        Slot* _slots;
+    };
+
+    /// Run function while mutex is locked.
+    template <typename Mutex, typename Function>
+    void runLocked(Mutex& mutex, Function& function)
+    {
+        std::lock_guard<Mutex> lockGuard{ mutex };
+        function();
+    }
+
+    /// Run function while mutex is locked, possibly combined with the
+    /// sections of other threads (see FlatCombiningMutex::run).
+    template <typename Mutex, size_t Slots, typename Function>
+    void runLocked(FlatCombiningMutex<Mutex, Slots>& mutex, Function& function)
+    {
+        mutex.run(function);
+    }
+} // namespace CppDiFactory
+
+#endif // FLATCOMBINING_H
@@ -0,0 +1,129 @@
+#ifndef FROZENREGISTRY_H
+#define FROZENREGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "NumaTopology.h"
+
+namespace CppDiFactory
+{
+    /// Read-only hash table from type ids to registrations, built once.
+    /// The entries are stored in one contiguous array (open addressing with
+    /// linear probing, at most half full), so a lookup usually touches a
+    /// single cache line and never follows a node pointer.
+    template <typename Value>
+    class FrozenLookupTable
+    {
+    public:
+        explicit FrozenLookupTable(const std::vector<std::pair<size_t, Value*> >& entries): _mask(0)
+        {
+            size_t capacity = 2;
+            while (capacity < 2 * entries.size()){
+                capacity *= 2;
+            }
+            _mask = capacity - 1;
+            _slots.assign(capacity, Slot{ 0, nullptr });
+
+            for (const auto& entry : entries){
+                size_t slot = position(entry.first);
+                while (_slots[slot].value){
+                    slot = (slot + 1) & _mask;
+                }
+                _slots[slot] = Slot{ entry.first, entry.second };
+            }
+        }
+
+        /// \return nullptr if the key is unknown
+        Value* find(size_t key) const
+        {
+            for (size_t slot = position(key); _slots[slot].value; slot = (slot + 1) & _mask){
+                if (_slots[slot].key == key){
+                    return _slots[slot].value;
+                }
+            }
+            return nullptr;
+        }
+
+        size_t capacity() const
+        {
+            return _slots.size();
+        }
+
+    private:
+        struct Slot
+        {
+            size_t key;
+            Value* value;
+        };
+
+        size_t position(size_t key) const
+        {
+            // type ids are addresses, the low bits carry little information
+            return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 32) & _mask;
+        }
+
+        size_t _mask;
+        std::vector<Slot> _slots;
+    };
+
+    /// Lookup tables of a frozen registry, optionally one copy per NUMA node
+    /// (allocated on that node) so that lookups only read node-local memory.
+    /// The values (registrations with their singleton slots) are shared by all
+    /// copies; they hold mutable state and can not be replicated.
+    template <typename Value>
+    class FrozenRegistry
+    {
+    public:
+        /// Build the lookup tables.
+        /// \param replicate  one copy per NUMA node (single copy on single node machines)
+        void build(const std::vector<std::pair<size_t, Value*> >& entries, bool replicate)
+        {
+            const NumaTopology& topology = NumaTopology::instance();
+            std::vector<std::unique_ptr<FrozenLookupTable<Value> > > tables(replicate ? topology.nodeCount() : 1);
+            if (tables.size() > 1){
+                for (size_t node = 0; node < tables.size(); ++node){
+                    topology.runOnNode(node, [&]() {
+                        tables[node].reset(new FrozenLookupTable<Value>(entries));
+                    });
+                }
+            } else {
+                tables[0].reset(new FrozenLookupTable<Value>(entries));
+            }
+            _tables.swap(tables);
+        }
+
+        void clear()
+        {
+            _tables.clear();
+        }
+
+        bool built() const
+        {
+            return !_tables.empty();
+        }
+
+        /// Number of copies of the lookup table.
+        size_t replicas() const
+        {
+            return _tables.size();
+        }
+
+        /// Find a value in the copy of the node the calling thread runs on
+        /// (see NumaTopology::cachedCurrentNode).
+        /// \return nullptr if the key is unknown
+        Value* find(size_t key) const
+        {
+            const size_t node = _tables.size() > 1 ? NumaTopology::instance().cachedCurrentNode() : 0;
+            return _tables[node < _tables.size() ? node : 0]->find(key);
+        }
+
+    private:
+        std::vector<std::unique_ptr<FrozenLookupTable<Value> > > _tables;
+    };
+} // namespace CppDiFactory
+
+#endif // FROZENREGISTRY_H
@@ -0,0 +1,72 @@
+#ifndef INTERCEPTOR_H
+#define INTERCEPTOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+
+#include "Lifetimes.h"
+#include "TypeName.h"
+
+namespace CppDiFactory
+{
+    /// Data passed to the hooks of a ConstructionInterceptor.
+    struct InterceptionEvent
+    {
+        /// type id (see type_id) and type of the registration
+        size_t typeId;
+        const std::type_info* type;
+        RegistrationKind kind;
+        /// id of the request (0: outside of a request, e.g. background refresh)
+        uint64_t requestId;
+        std::chrono::steady_clock::time_point timestamp;
+        /// the instance (afterConstruction, singletonCreated, requestEnd; otherwise nullptr)
+        const void* instance;
+
+        std::string typeName() const
+        {
+            return CppDiFactory::typeName(*type);
+        }
+    };
+
+    /// Hooks called by the DiFactory (see DiFactory::setInterceptor).
+    /// The hooks are called synchronously on the thread doing the work, mostly
+    /// while the factory is locked: they must be fast, must not use the factory
+    /// and must not throw.
+    class ConstructionInterceptor
+    {
+    public:
+        virtual ~ConstructionInterceptor() = default;
+
+        /// A request (getInstance) for the type of the event starts.
+        virtual void requestBegin(const InterceptionEvent&) {}
+        /// A request finished (the instance is nullptr if the request failed).
+        virtual void requestEnd(const InterceptionEvent&) {}
+        /// The factory is about to construct an instance (the dependencies are resolved).
+        virtual void beforeConstruction(const InterceptionEvent&) {}
+        virtual void afterConstruction(const InterceptionEvent&) {}
+        /// A singleton instance was created.
+        virtual void singletonCreated(const InterceptionEvent&) {}
+        /// A singleton instance was destroyed (reported when the factory notices
+        /// it, i.e. with the next request for the singleton).
+        virtual void singletonExpired(const InterceptionEvent&) {}
+    };
+
+    /// Id of the request running on the current thread (0: none).
+    inline uint64_t& currentRequestId()
+    {
+        static thread_local uint64_t requestId = 0;
+        return requestId;
+    }
+} // namespace CppDiFactory
+
+/// Interceptors can be removed at compile time by defining CPPDIFACTORY_NO_INTERCEPTORS.
+#if defined(CPPDIFACTORY_NO_INTERCEPTORS)
+#define CPPDIFACTORY_INTERCEPT(factory, hook, registration, instance) do { } while (0)
+#else
+#define CPPDIFACTORY_INTERCEPT(factory, hook, registration, instance) \
+    (factory).intercept(&::CppDiFactory::ConstructionInterceptor::hook, (registration), (instance))
+#endif
+
+#endif // INTERCEPTOR_H
@@ -0,0 +1,331 @@
+#ifndef LIFETIMEADVISOR_H
+#define LIFETIMEADVISOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Lifetimes.h"
+
+namespace CppDiFactory
+{
+    /// Observed behavior of the instances of a type (see LifetimeRecorder).
+    struct LifetimeObservation
+    {
+        LifetimeObservation():
+            constructions(0), constructionTime(0), identicalDependencies(true), dependencyIdentity(0),
+            tracked(0), destroyed(0), maxLifetime(0), totalLifetime(0), maxAlive(0),
+            expiries(0), requestCreations(0), requestReuses(0) {}
+
+        /// constructions and their total time (constructor and allocation only)
+        size_t constructions;
+        std::chrono::nanoseconds constructionTime;
+        /// all constructions got the same dependency instances
+        bool identicalDependencies;
+        uint64_t dependencyIdentity;
+        /// instances whose destruction is observed, destroyed ones and their lifetimes
+        size_t tracked;
+        size_t destroyed;
+        std::chrono::nanoseconds maxLifetime;
+        std::chrono::nanoseconds totalLifetime;
+        /// maximum number of tracked instances alive at the same time
+        size_t maxAlive;
+        /// singletons created again after the previous instance expired
+        size_t expiries;
+        /// single instance per request: instances created / reused within a request
+        size_t requestCreations;
+        size_t requestReuses;
+
+        std::chrono::nanoseconds averageConstructionTime() const
+        {
+            return constructions ? std::chrono::nanoseconds(constructionTime.count() / static_cast<std::chrono::nanoseconds::rep>(constructions)) : std::chrono::nanoseconds(0);
+        }
+    };
+
+    /// Records the behavior of instances per type for the lifetime advisor
+    /// (see DiFactory::enableLifetimeAdvisor).
+    /// Instances may outlive the factory, so they keep the recorder alive.
+    class LifetimeRecorder
+    {
+    public:
+        LifetimeRecorder(): _enabled(false) {}
+
+        void enable(bool enable)
+        {
+            _enabled.store(enable, std::memory_order_relaxed);
+        }
+
+        bool enabled() const
+        {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        /// Record a construction.
+        /// \param identity  hash of the addresses of the dependency instances
+        /// \param tracked   the destruction of the instance is reported (see recordDestruction)
+        void recordConstruction(size_t typeId, uint64_t identity, std::chrono::nanoseconds duration, bool tracked)
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            LifetimeObservation& observation = _observations[typeId];
+            if (observation.constructions == 0){
+                observation.dependencyIdentity = identity;
+            } else if (observation.dependencyIdentity != identity){
+                observation.identicalDependencies = false;
+            }
+            ++observation.constructions;
+            observation.constructionTime += duration;
+            if (tracked){
+                ++observation.tracked;
+                observation.maxAlive = std::max(observation.maxAlive, observation.tracked - observation.destroyed);
+            }
+        }
+
+        void recordDestruction(size_t typeId, std::chrono::nanoseconds lifetime)
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            LifetimeObservation& observation = _observations[typeId];
+            ++observation.destroyed;
+            observation.totalLifetime += lifetime;
+            observation.maxLifetime = std::max(observation.maxLifetime, lifetime);
+        }
+
+        void recordExpiry(size_t typeId)
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+            ++_observations[typeId].expiries;
+        }
+
+        /// Record a request for a single instance per request type.
+        /// \param reused  the instance of the request was used again
+        void recordRequestInstance(size_t typeId, bool reused)
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            LifetimeObservation& observation = _observations[typeId];
+            ++(reused ? observation.requestReuses : observation.requestCreations);
+        }
+
+        std::unordered_map<size_t, LifetimeObservation> observations() const
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+            return _observations;
+        }
+
+        void reset()
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+            _observations.clear();
+        }
+
+    private:
+        std::atomic<bool> _enabled;
+        mutable std::mutex _mutex;
+        std::unordered_map<size_t, LifetimeObservation> _observations;
+    };
+
+    /// Deleter reporting the lifetime of an instance to a LifetimeRecorder.
+    template <typename Class>
+    class LifetimeTrackingDeleter
+    {
+    public:
+        LifetimeTrackingDeleter(std::shared_ptr<LifetimeRecorder> recorder, size_t typeId):
+            _recorder(recorder), _typeId(typeId), _created(std::chrono::steady_clock::now()) {}
+
+        void operator()(Class* instance) const
+        {
+            delete instance;
+            _recorder->recordDestruction(_typeId, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _created));
+        }
+
+    private:
+        std::shared_ptr<LifetimeRecorder> _recorder;
+        size_t _typeId;
+        std::chrono::steady_clock::time_point _created;
+    };
+
+    /// Thresholds of the lifetime advisor.
+    struct LifetimeAdvisorOptions
+    {
+        LifetimeAdvisorOptions():
+            minObservations(10), shortLived(std::chrono::milliseconds(10)), minExpiries(3), lazyShare(0.5),
+            lazyMinTime(std::chrono::microseconds(100)) {}
+
+        /// minimum number of observations before anything is recommended (at least 1)
+        size_t minObservations;
+        /// instances living at most this long are short-lived
+        std::chrono::nanoseconds shortLived;
+        /// singletons expiring at least this often are retention candidates (at least 1)
+        size_t minExpiries;
+        /// share of the construction time of a consumer taken by a transient
+        /// dependency to make it a Lazy candidate
+        double lazyShare;
+        /// minimum average construction time of a Lazy candidate
+        std::chrono::nanoseconds lazyMinTime;
+    };
+
+    /// A recommended lifetime change.
+    ///   - Singleton: transient instances are short-lived, never alive at the same time
+    ///                and always built from the same dependencies (registerSingleton)
+    ///   - Pool:      like Singleton, but several instances are alive at the same time
+    ///                (pool of at most poolSize instances)
+    ///   - Retain:    singleton is created again and again after expiring (InterfaceForType::retain)
+    ///   - Lazy:      transient dependency takes most of the construction time of its
+    ///                consumer; if the consumer rarely uses it, create it on first use
+    ///   - Transient: single instance per request type is never shared within a request (registerClass)
+    struct LifetimeAdvice
+    {
+        enum class Change { Singleton, Pool, Retain, Lazy, Transient };
+
+        size_t typeId;
+        std::string type;
+        Change change;
+        /// consumer of a Lazy dependency (empty otherwise)
+        std::string consumer;
+        size_t poolSize;
+        /// instances observed and savings expected with the change (Lazy: at most)
+        size_t observed;
+        size_t savedConstructions;
+        size_t savedAllocations;
+        std::string reason;
+
+        static const char* changeName(Change change)
+        {
+            switch (change){
+            case Change::Singleton: return "singleton";
+            case Change::Pool:      return "pool";
+            case Change::Retain:    return "retain";
+            case Change::Lazy:      return "lazy";
+            default:                return "transient";
+            }
+        }
+
+        std::string describe() const
+        {
+            return type + ": " + changeName(change) + (consumer.empty() ? std::string() : " in " + consumer) + " (" + reason + ")";
+        }
+    };
+
+    /// Result of DiFactory::adviseLifetimes, largest savings first.
+    struct LifetimeReport
+    {
+        std::vector<LifetimeAdvice> advice;
+        /// constructions observed and savings of all recommendations
+        /// (except Lazy ones, their savings depend on the usage)
+        size_t constructions;
+        size_t savedConstructions;
+        size_t savedAllocations;
+    };
+
+    /// Registered type as seen by the lifetime advisor.
+    struct LifetimeSubject
+    {
+        size_t typeId;
+        std::string type;
+        RegistrationKind kind;
+        /// direct dependencies (interfaces replaced by the classes implementing them)
+        std::vector<size_t> dependencies;
+        LifetimeObservation observation;
+    };
+
+    /// Derive lifetime recommendations from observed behavior.
+    inline LifetimeReport adviseLifetimes(const std::vector<LifetimeSubject>& subjects, const LifetimeAdvisorOptions& options)
+    {
+        LifetimeReport report{ {}, 0, 0, 0 };
+        // nothing can be saved for types which have not been observed at all
+        const size_t minObservations = std::max<size_t>(options.minObservations, 1);
+        const size_t minExpiries = std::max<size_t>(options.minExpiries, 1);
+        std::unordered_map<size_t, const LifetimeSubject*> byId;
+        for (const LifetimeSubject& subject : subjects){
+            byId[subject.typeId] = &subject;
+            report.constructions += subject.observation.constructions;
+        }
+
+        for (const LifetimeSubject& subject : subjects){
+            const LifetimeObservation& observed = subject.observation;
+            LifetimeAdvice advice{ subject.typeId, subject.type, LifetimeAdvice::Change::Singleton, std::string(), 0,
+                                   observed.constructions, 0, 0, std::string() };
+
+            switch (subject.kind){
+            case RegistrationKind::Class:
+                if (observed.constructions >= minObservations && observed.identicalDependencies &&
+                    observed.destroyed == observed.tracked && observed.tracked == observed.constructions &&
+                    observed.maxLifetime <= options.shortLived){
+                    const size_t kept = std::max<size_t>(observed.maxAlive, 1);
+                    advice.change = kept == 1 ? LifetimeAdvice::Change::Singleton : LifetimeAdvice::Change::Pool;
+                    advice.poolSize = kept;
+                    advice.savedConstructions = observed.constructions > kept ? observed.constructions - kept : 0;
+                    advice.savedAllocations = advice.savedConstructions;
+                    advice.reason = "short-lived, same dependencies, at most " + std::to_string(kept) + " alive";
+                    report.advice.push_back(advice);
+                }
+
+                for (size_t dependency : subject.dependencies){
+                    const auto it = byId.find(dependency);
+                    if (it == byId.end() || it->second->kind != RegistrationKind::Class || observed.constructions < minObservations){
+                        continue;
+                    }
+                    std::chrono::nanoseconds total = observed.averageConstructionTime();
+                    for (size_t other : subject.dependencies){
+                        const auto o = byId.find(other);
+                        if (o != byId.end() && o->second->kind == RegistrationKind::Class){
+                            total += o->second->observation.averageConstructionTime();
+                        }
+                    }
+                    const std::chrono::nanoseconds own = it->second->observation.averageConstructionTime();
+                    // own is part of total, no share of untimed constructions (zero) is computed
+                    if (own.count() > 0 && own >= options.lazyMinTime && own.count() >= options.lazyShare * total.count()){
+                        LifetimeAdvice lazy{ dependency, it->second->type, LifetimeAdvice::Change::Lazy, subject.type, 0,
+                                             observed.constructions, observed.constructions, observed.constructions,
+                                             std::to_string(100 * own.count() / total.count()) + "% of the construction time" };
+                        report.advice.push_back(lazy);
+                    }
+                }
+                break;
+
+            case RegistrationKind::Singleton:
+                if (observed.expiries >= minExpiries){
+                    advice.change = LifetimeAdvice::Change::Retain;
+                    advice.savedConstructions = observed.expiries;
+                    advice.savedAllocations = observed.expiries;
+                    advice.reason = "created again " + std::to_string(observed.expiries) + " times after expiring";
+                    report.advice.push_back(advice);
+                }
+                break;
+
+            case RegistrationKind::SingleInstancePerRequest:
+                if (observed.requestCreations >= minObservations && observed.requestReuses == 0){
+                    advice.change = LifetimeAdvice::Change::Transient;
+                    advice.observed = observed.requestCreations;
+                    // one node in the request map per request
+                    advice.savedAllocations = observed.requestCreations;
+                    advice.reason = "never shared within a request";
+                    report.advice.push_back(advice);
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        for (const LifetimeAdvice& advice : report.advice){
+            report.savedConstructions += advice.change == LifetimeAdvice::Change::Lazy ? 0 : advice.savedConstructions;
+            report.savedAllocations += advice.change == LifetimeAdvice::Change::Lazy ? 0 : advice.savedAllocations;
+        }
+        std::sort(report.advice.begin(), report.advice.end(), [](const LifetimeAdvice& a, const LifetimeAdvice& b) {
+            return a.savedConstructions + a.savedAllocations > b.savedConstructions + b.savedAllocations;
+        });
+        return report;
+    }
+} // namespace CppDiFactory
+
+#endif // LIFETIMEADVISOR_H
@@ -0,0 +1,89 @@
+#ifndef LIFETIMES_H
+#define LIFETIMES_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace CppDiFactory
+{
+    /// Kind of registration of a type (i.e. which registerXY method was used).
+    enum class RegistrationKind
+    {
+        Interface,                  ///< registerInterface / withInterfaces
+        Class,                      ///< registerClass
+        Composite,                  ///< registerComposite
+        Instance,                   ///< registerInstance
+        Singleton,                  ///< registerSingleton
+        Refreshing,                 ///< registerRefreshing
+        MappedImage,                ///< registerMappedImage
+        SingleInstancePerRequest,   ///< registerInstancePerRequest
+        InstanceProvidedAtRequest   ///< registerInstanceProvidedAtRequest
+    };
+
+    /// How long an instance provided by the factory typically lives, shortest first.
+    ///   - Transient: a new instance for each use
+    ///   - Request:   shared within one request
+    ///   - Singleton: shared while it is used
+    ///   - Permanent: kept by the factory
+    enum class Lifetime { Transient, Request, Singleton, Permanent };
+
+    /// Lifetime of the instances of a registration kind
+    /// (interfaces have the lifetime of the class implementing them).
+    inline Lifetime lifetimeOf(RegistrationKind kind)
+    {
+        switch (kind){
+        case RegistrationKind::SingleInstancePerRequest:
+        case RegistrationKind::InstanceProvidedAtRequest:
+            return Lifetime::Request;
+        case RegistrationKind::Singleton:
+            return Lifetime::Singleton;
+        case RegistrationKind::Instance:
+        case RegistrationKind::Refreshing:
+        case RegistrationKind::MappedImage:
+            return Lifetime::Permanent;
+        default:
+            return Lifetime::Transient;
+        }
+    }
+
+    inline const char* lifetimeName(Lifetime lifetime)
+    {
+        switch (lifetime){
+        case Lifetime::Transient: return "transient";
+        case Lifetime::Request:   return "per request";
+        case Lifetime::Singleton: return "singleton";
+        default:                  return "permanent";
+        }
+    }
+
+    /// What the factory does when validation finds a captive dependency.
+    ///   - Ignore: no analysis
+    ///   - Report: keep the findings (see DiFactory::captiveDependencies) and
+    ///             call the reporter (if any)
+    ///   - Reject: throw an exception (like for other registration errors)
+    enum class CaptiveDependencyPolicy { Ignore, Report, Reject };
+
+    /// A dependency of an instance on a type with a shorter lifetime: the
+    /// holder keeps the captured instance alive for its own lifetime.
+    struct CaptiveDependency
+    {
+        size_t holder;              ///< type id of the holder
+        size_t captive;             ///< type id of the captured type
+        Lifetime holderLifetime;
+        Lifetime captiveLifetime;
+        /// type names from the holder to the captured type (including interfaces in between)
+        std::vector<std::string> path;
+
+        std::string describe() const
+        {
+            std::string result;
+            for (const std::string& name : path){
+                result += result.empty() ? name : " -> " + name;
+            }
+            return result + " (" + lifetimeName(holderLifetime) + " captures " + lifetimeName(captiveLifetime) + ")";
+        }
+    };
+} // namespace CppDiFactory
+
+#endif // LIFETIMES_H
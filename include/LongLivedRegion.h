@@ -0,0 +1,244 @@
+#ifndef LONGLIVEDREGION_H
+#define LONGLIVEDREGION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace CppDiFactory
+{
+    /// Page backing used for a LongLivedRegion.
+    ///   - None:        regular pages
+    ///   - Transparent: regular mapping, advised as transparent huge pages
+    ///   - Explicit:    explicit huge pages (MAP_HUGETLB), falls back to
+    ///                  Transparent if no huge pages are reserved
+    enum class HugePages { None, Transparent, Explicit };
+
+    /// Contiguous memory region for long-lived objects created by the DiFactory.
+    /// The region is a simple bump allocator: objects are placed one after the other
+    /// in the order they are created, which for singletons is the dependency order
+    /// (dependencies are always created before the objects using them).
+    /// Memory of released objects is not reused individually, but the region is
+    /// rewound once all objects allocated from it have been released.
+    /// If the region is exhausted, allocate() returns nullptr and the caller has
+    /// to fall back to the regular heap.
+    class LongLivedRegion
+    {
+    public:
+        LongLivedRegion(size_t capacity, HugePages hugePages = HugePages::None):
+            _begin(nullptr), _capacity(0), _mappedSize(0), _mapping(nullptr), _offset(0), _live(0)
+        {
+            map(capacity, hugePages);
+        }
+
+        ~LongLivedRegion()
+        {
+#if defined(__linux__)
+            if (_mapping){
+                munmap(_mapping, _mappedSize);
+                return;
+            }
+#endif
+            ::operator delete(_begin);
+        }
+
+        LongLivedRegion(const LongLivedRegion&) = delete;
+        LongLivedRegion& operator=(const LongLivedRegion&) = delete;
+
+        /// Allocate size bytes with the given alignment from the region.
+        /// \return pointer to the memory or nullptr if the region is exhausted
+        void* allocate(size_t size, size_t alignment)
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            const std::uintptr_t base    = reinterpret_cast<std::uintptr_t>(_begin);
+            const std::uintptr_t current = base + _offset;
+            const std::uintptr_t aligned = (current + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+
+            if (aligned + size > base + _capacity){
+                return nullptr;
+            }
+
+            _offset = (aligned - base) + size;
+            ++_live;
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        /// Release memory previously returned by allocate().
+        void deallocate(void*)
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            if (--_live == 0){
+                _offset = 0;
+            }
+        }
+
+        /// Check if the supplied pointer lies within this region.
+        bool contains(const void* ptr) const
+        {
+            const char* p = static_cast<const char*>(ptr);
+            return p >= _begin && p < _begin + _capacity;
+        }
+
+        /// Return the unused (page aligned) rest of the region to the operating system.
+        /// The memory is still available for further allocations.
+        /// Nothing is released if the region could not be mapped (e.g. not on Linux)
+        /// and had to be allocated from the heap.
+        /// \return number of bytes released
+        size_t releaseSlack()
+        {
+#if defined(__linux__)
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            if (_mapping){
+                const std::uintptr_t pageSize = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+                const std::uintptr_t end   = reinterpret_cast<std::uintptr_t>(_begin) + _capacity;
+                const std::uintptr_t start = (reinterpret_cast<std::uintptr_t>(_begin) + _offset + pageSize - 1) & ~(pageSize - 1);
+                if (start < end && madvise(reinterpret_cast<void*>(start), end - start, MADV_DONTNEED) == 0){
+                    return end - start;
+                }
+            }
+#endif
+            return 0;
+        }
+
+        size_t capacity() const
+        {
+            return _capacity;
+        }
+
+        size_t used() const
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+            return _offset;
+        }
+
+    private:
+        static const size_t hugePageSize = 2 * 1024 * 1024;
+
+        void map(size_t capacity, HugePages hugePages)
+        {
+#if defined(__linux__)
+            if (hugePages == HugePages::None){
+                // mapped as well (instead of taken from the heap), so releaseSlack can drop unused pages
+                const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+                const size_t size = (capacity + pageSize - 1) & ~(pageSize - 1);
+                void* mapping = size ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+                if (mapping != MAP_FAILED){
+                    _mapping = mapping;
+                    _mappedSize = size;
+                    _begin = static_cast<char*>(mapping);
+                    _capacity = capacity;
+                    return;
+                }
+            } else {
+                const size_t size = (capacity + hugePageSize - 1) & ~(hugePageSize - 1);
+#if defined(MAP_HUGETLB)
+                if (hugePages == HugePages::Explicit){
+                    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                    if (mapping != MAP_FAILED){
+                        _mapping = mapping;
+                        _mappedSize = size;
+                        _begin = static_cast<char*>(mapping);
+                        _capacity = size;
+                        return;
+                    }
+                }
+#endif
+                // over-allocate by one huge page to get a huge page aligned start address
+                void* mapping = mmap(nullptr, size + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (mapping != MAP_FAILED){
+                    _mapping = mapping;
+                    _mappedSize = size + hugePageSize;
+                    const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(mapping);
+                    _begin = reinterpret_cast<char*>((start + hugePageSize - 1) & ~(static_cast<std::uintptr_t>(hugePageSize) - 1));
+                    _capacity = size;
+#if defined(MADV_HUGEPAGE)
+                    madvise(_begin, _capacity, MADV_HUGEPAGE);
+#endif
+                    return;
+                }
+            }
+#else
+            (void)hugePages;
+#endif
+            _begin = static_cast<char*>(::operator new(capacity));
+            _capacity = capacity;
+        }
+
+        char*  _begin;
+        size_t _capacity;
+        size_t _mappedSize;
+        void*  _mapping;
+        size_t _offset;
+        size_t _live;
+        mutable std::mutex _mutex;
+    };
+
+    /// Allocator placing objects (and their shared_ptr control blocks when used with
+    /// std::allocate_shared) into a LongLivedRegion.
+    /// The allocator keeps the region alive, so objects may outlive the DiFactory.
+    /// If the region is exhausted, the regular heap is used.
+    template <typename T>
+    class RegionAllocator
+    {
+    public:
+        using value_type = T;
+
+        template <typename U>
+        struct rebind { using other = RegionAllocator<U>; };
+
+        RegionAllocator(std::shared_ptr<LongLivedRegion> region): _region(region) {}
+
+        template <typename U>
+        RegionAllocator(const RegionAllocator<U>& other): _region(other.region()) {}
+
+        T* allocate(size_t n)
+        {
+            void* p = _region->allocate(n * sizeof(T), alignof(T));
+            if (!p){
+                p = ::operator new(n * sizeof(T));
+            }
+            return static_cast<T*>(p);
+        }
+
+        void deallocate(T* p, size_t)
+        {
+            if (_region->contains(p)){
+                _region->deallocate(p);
+            } else {
+                ::operator delete(p);
+            }
+        }
+
+        const std::shared_ptr<LongLivedRegion>& region() const
+        {
+            return _region;
+        }
+
+        template <typename U>
+        bool operator==(const RegionAllocator<U>& other) const
+        {
+            return _region == other.region();
+        }
+
+        template <typename U>
+        bool operator!=(const RegionAllocator<U>& other) const
+        {
+            return _region != other.region();
+        }
+
+    private:
+        std::shared_ptr<LongLivedRegion> _region;
+    };
+} // namespace CppDiFactory
+
+#endif // LONGLIVEDREGION_H
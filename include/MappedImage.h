@@ -0,0 +1,158 @@
+#ifndef MAPPEDIMAGE_H
+#define MAPPEDIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CPPDIFACTORY_HAS_MMAP 1
+#endif
+
+namespace CppDiFactory
+{
+    /// Opt-in for image files (see registerMappedImage): specialize as
+    /// std::true_type for types whose bytes are meaningful in another process,
+    /// i.e. types without pointers, references or handles (is_trivially_copyable
+    /// does not exclude those).
+    /// \code
+    ///   namespace CppDiFactory { template <> struct MappableImage<LookupTable> : std::true_type {}; }
+    /// \endcode
+    template <typename T>
+    struct MappableImage : std::false_type {};
+
+    /// Image files of trivially copyable (pointer-free) objects.
+    /// An image consists of a header (identifying the type by name, size,
+    /// alignment and a version supplied by the caller) followed by the raw
+    /// bytes of the object.
+    /// Images are only valid for the same type layout; change the version
+    /// whenever the layout (or the meaning of the data) changes.
+    class MappedImage
+    {
+    public:
+        /// Map an image file copy-on-write: the object may be modified, but the
+        /// changes stay in this process and are not written to the file.
+        /// \param version  version of the layout, must match the written image
+        /// \return the mapped object or nullptr if the file does not exist or
+        ///         does not contain an image of type T with this version.
+        template <typename T>
+        static std::shared_ptr<T> map(const std::string& path, uint64_t version)
+        {
+#if defined(CPPDIFACTORY_HAS_MMAP)
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0){
+                return nullptr;
+            }
+
+            struct stat info;
+            const size_t size = headerSize + sizeof(T);
+            if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != size){
+                ::close(fd);
+                return nullptr;
+            }
+
+            void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mapping == MAP_FAILED){
+                return nullptr;
+            }
+
+            const Header expected = header<T>(version);
+            if (std::memcmp(mapping, &expected, sizeof(Header)) != 0){
+                munmap(mapping, size);
+                return nullptr;
+            }
+
+            T* instance = reinterpret_cast<T*>(static_cast<char*>(mapping) + headerSize);
+            return std::shared_ptr<T>(instance, [mapping, size](T*) { munmap(mapping, size); });
+#else
+            (void)path;
+            (void)version;
+            return nullptr;
+#endif
+        }
+
+        /// Write the image of instance to path (replacing an existing file atomically).
+        /// \return true on success
+        template <typename T>
+        static bool write(const std::string& path, const T& instance, uint64_t version)
+        {
+#if defined(CPPDIFACTORY_HAS_MMAP)
+            const std::string temporary = path + ".tmp" + std::to_string(static_cast<long>(getpid()));
+            std::FILE* file = std::fopen(temporary.c_str(), "wb");
+            if (!file){
+                return false;
+            }
+
+            char headerBytes[headerSize] = {};
+            const Header imageHeader = header<T>(version);
+            std::memcpy(headerBytes, &imageHeader, sizeof(Header));
+
+            bool written = std::fwrite(headerBytes, headerSize, 1, file) == 1
+                        && std::fwrite(&instance, sizeof(T), 1, file) == 1;
+            written = (std::fclose(file) == 0) && written;
+
+            if (!written || std::rename(temporary.c_str(), path.c_str()) != 0){
+                std::remove(temporary.c_str());
+                return false;
+            }
+            return true;
+#else
+            (void)path;
+            (void)instance;
+            (void)version;
+            return false;
+#endif
+        }
+
+    private:
+        /// header is padded to this size, the object starts at this (aligned) offset
+        static const size_t headerSize = 64;
+
+        struct Header
+        {
+            char     magic[8];
+            uint64_t size;
+            uint64_t alignment;
+            uint64_t typeHash;
+            uint64_t version;
+        };
+
+        template <typename T>
+        static Header header(uint64_t version)
+        {
+            static_assert(alignof(T) <= headerSize, "alignment of mapped type is too big");
+
+            Header result;
+            std::memset(&result, 0, sizeof(result));
+            std::memcpy(result.magic, "DIIMAGE2", sizeof(result.magic));
+            result.size      = sizeof(T);
+            result.alignment = alignof(T);
+            result.typeHash  = hash(typeid(T).name());
+            result.version   = version;
+            return result;
+        }
+
+        /// FNV-1a hash
+        static uint64_t hash(const char* text)
+        {
+            uint64_t value = 14695981039346656037ULL;
+            for (; *text; ++text){
+                value ^= static_cast<unsigned char>(*text);
+                value *= 1099511628211ULL;
+            }
+            return value;
+        }
+    };
+} // namespace CppDiFactory
+
+#endif // MAPPEDIMAGE_H
@@ -0,0 +1,131 @@
+#ifndef MEMORYPRESSUREWATCHER_H
+#define MEMORYPRESSUREWATCHER_H
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace CppDiFactory
+{
+    /// Level of memory pressure (see DiFactory::onMemoryPressure).
+    enum class MemoryPressure { Low, Moderate, Critical };
+
+    /// Watches Linux pressure stall information (PSI) for memory and reports
+    /// stalls to a callback (on a background thread):
+    ///   - Moderate: some tasks stalled on memory for 150ms within 1s
+    ///   - Critical: all tasks stalled on memory for 100ms within 1s
+    class MemoryPressureWatcher
+    {
+    public:
+        using Callback = std::function<void(MemoryPressure)>;
+
+        MemoryPressureWatcher()
+        {
+            _stopPipe[0] = _stopPipe[1] = -1;
+            _triggers[0] = _triggers[1] = -1;
+        }
+
+        ~MemoryPressureWatcher()
+        {
+            stop();
+        }
+
+        MemoryPressureWatcher(const MemoryPressureWatcher&) = delete;
+        MemoryPressureWatcher& operator=(const MemoryPressureWatcher&) = delete;
+
+        /// Start watching the supplied PSI file (e.g. /proc/pressure/memory or
+        /// the memory.pressure file of a cgroup).
+        /// \return false if PSI triggers are not supported for this file
+        bool start(const std::string& path, Callback callback)
+        {
+            stop();
+#if defined(__linux__)
+            _triggers[0] = openTrigger(path, "some 150000 1000000");
+            _triggers[1] = openTrigger(path, "full 100000 1000000");
+            if (_triggers[0] < 0 || _triggers[1] < 0 || pipe(_stopPipe) != 0){
+                stop();
+                return false;
+            }
+
+            _thread = std::thread([this, callback]() { run(callback); });
+            return true;
+#else
+            (void)path;
+            (void)callback;
+            return false;
+#endif
+        }
+
+        void stop()
+        {
+#if defined(__linux__)
+            // closing the write end wakes up the thread (POLLHUP), which cannot fail like a write;
+            // the other descriptors are used by the thread until it has been joined
+            if (_stopPipe[1] >= 0){
+                close(_stopPipe[1]);
+                _stopPipe[1] = -1;
+            }
+            if (_thread.joinable()){
+                _thread.join();
+            }
+            for (int* fd : { &_stopPipe[0], &_triggers[0], &_triggers[1] }){
+                if (*fd >= 0){
+                    close(*fd);
+                    *fd = -1;
+                }
+            }
+#endif
+        }
+
+    private:
+#if defined(__linux__)
+        static int openTrigger(const std::string& path, const char* trigger)
+        {
+            const int fd = open(path.c_str(), O_RDWR | O_NONBLOCK);
+            if (fd < 0){
+                return -1;
+            }
+            if (write(fd, trigger, std::strlen(trigger) + 1) < 0){
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        void run(Callback callback)
+        {
+            while (true){
+                pollfd fds[3] = {
+                    { _stopPipe[0], POLLIN, 0 },
+                    { _triggers[0], POLLPRI, 0 },
+                    { _triggers[1], POLLPRI, 0 }
+                };
+                if (poll(fds, 3, -1) < 0){
+                    continue;
+                }
+                if (fds[0].revents || (fds[1].revents & POLLERR) || (fds[2].revents & POLLERR)){
+                    return;
+                }
+                if (fds[2].revents & POLLPRI){
+                    callback(MemoryPressure::Critical);
+                } else if (fds[1].revents & POLLPRI){
+                    callback(MemoryPressure::Moderate);
+                }
+            }
+        }
+#endif
+
+        int _stopPipe[2];
+        int _triggers[2];
+        std::thread _thread;
+    };
+} // namespace CppDiFactory
+
+#endif // MEMORYPRESSUREWATCHER_H
@@ -0,0 +1,150 @@
+#ifndef NUMATOPOLOGY_H
+#define NUMATOPOLOGY_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace CppDiFactory
+{
+    /// NUMA nodes of the machine and their CPUs (read from sysfs on Linux).
+    /// Nodes are numbered 0..nodeCount()-1. Machines without NUMA information
+    /// are treated as a single node.
+    class NumaTopology
+    {
+    public:
+        /// The topology of this machine (read once).
+        static const NumaTopology& instance()
+        {
+            static const NumaTopology topology;
+            return topology;
+        }
+
+        size_t nodeCount() const
+        {
+            return _nodeCpus.size();
+        }
+
+        const std::vector<int>& cpusOfNode(size_t node) const
+        {
+            return _nodeCpus[node];
+        }
+
+        /// Node of the CPU the calling thread is running on.
+        size_t currentNode() const
+        {
+#if defined(__linux__)
+            if (_nodeCpus.size() > 1){
+                const int cpu = sched_getcpu();
+                if (cpu >= 0 && static_cast<size_t>(cpu) < _cpuNode.size()){
+                    return _cpuNode[cpu];
+                }
+            }
+#endif
+            return 0;
+        }
+
+        /// Node of the calling thread, cached per thread and read again after
+        /// every 1024 calls (the scheduler may move the thread to another node).
+        size_t cachedCurrentNode() const
+        {
+            static thread_local size_t node = 0;
+            static thread_local unsigned int calls = 0;
+            if (calls++ % 1024 == 0){
+                node = currentNode();
+            }
+            return node;
+        }
+
+        /// Run function on a thread bound to the CPUs of node and wait for it.
+        /// Memory first touched by function is allocated on that node.
+        void runOnNode(size_t node, const std::function<void()>& function) const
+        {
+#if defined(__linux__)
+            std::thread thread([this, node, &function]() {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                for (int cpu : _nodeCpus[node]){
+                    CPU_SET(cpu, &cpus);
+                }
+                pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+                function();
+            });
+            thread.join();
+#else
+            (void)node;
+            function();
+#endif
+        }
+
+        /// Parse a sysfs CPU or node list (e.g. "0-3,8,10-11").
+        static std::vector<int> parseList(const std::string& list)
+        {
+            std::vector<int> result;
+            std::stringstream stream(list);
+            std::string range;
+            while (std::getline(stream, range, ',')){
+                if (range.empty() || range[0] == '\n'){
+                    continue;
+                }
+                const size_t dash = range.find('-');
+                const int first = std::atoi(range.substr(0, dash).c_str());
+                const int last  = dash == std::string::npos ? first : std::atoi(range.substr(dash + 1).c_str());
+                for (int i = first; i <= last; ++i){
+                    result.push_back(i);
+                }
+            }
+            return result;
+        }
+
+    private:
+        NumaTopology()
+        {
+            const std::string base = "/sys/devices/system/node/";
+            for (int node : parseList(readLine(base + "online"))){
+                std::vector<int> cpus = parseList(readLine(base + "node" + std::to_string(node) + "/cpulist"));
+                if (cpus.empty()){
+                    continue; // memory-only node
+                }
+                for (int cpu : cpus){
+                    if (static_cast<size_t>(cpu) >= _cpuNode.size()){
+                        _cpuNode.resize(cpu + 1, 0);
+                    }
+                    _cpuNode[cpu] = _nodeCpus.size();
+                }
+                _nodeCpus.push_back(cpus);
+            }
+
+            if (_nodeCpus.empty()){
+                std::vector<int> cpus;
+                for (unsigned int cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu){
+                    cpus.push_back(static_cast<int>(cpu));
+                }
+                _nodeCpus.push_back(cpus);
+            }
+        }
+
+        static std::string readLine(const std::string& path)
+        {
+            std::ifstream file(path.c_str());
+            std::string line;
+            std::getline(file, line);
+            return line;
+        }
+
+        std::vector<std::vector<int> > _nodeCpus;
+        std::vector<size_t> _cpuNode;
+    };
+} // namespace CppDiFactory
+
+#endif // NUMATOPOLOGY_H
@@ -0,0 +1,131 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+#include <chrono>
+#include <cstdint>
+
+/// Optional USDT (SystemTap style) static probes, provider "cppdifactory".
+/// The probes are compiled in when CPPDIFACTORY_USDT is defined (requires
+/// <sys/sdt.h>, e.g. from systemtap-sdt-dev). Each probe has a semaphore
+/// which is set while a tracer (bpftrace, perf, SystemTap) is attached to it;
+/// until then a probe costs a test of its semaphore, and neither its arguments
+/// nor the timestamps for its duration are computed. Without CPPDIFACTORY_USDT
+/// the probes (and their arguments) are removed completely.
+/// \note Semaphores are enabled for the whole translation unit (_SDT_HAS_SEMAPHORES):
+///       include this header before <sys/sdt.h>, and define the semaphores of
+///       other providers probed in the same translation unit.
+///
+/// Probes (type: address based type id, name: mangled type name, ns: nanoseconds):
+///   get_instance_entry  (type, name)
+///   get_instance_return (type, name, ns)      duration of the request incl. locking
+///   construct_entry     (type, name)
+///   construct_return    (type, name, ns)      duration of the constructor call
+///   singleton_create    (type, name, instance)
+///   singleton_expire    (type, name)          expired singleton detected by the factory
+///   lock_acquire        (ns)                  time spent waiting for the factory lock
+///   lock_release        (ns)                  time the factory lock was held
+///   register_type       (type, name)
+///   unregister_type     (type, name)
+/// The lock probes only exist with MULTITHREADED (without it the factory has no lock).
+///
+/// List the probes of a binary with e.g.:
+///   readelf -n <binary> | grep -A2 cppdifactory
+///   bpftrace -l 'usdt:<binary>:cppdifactory:*'
+#if defined(CPPDIFACTORY_USDT)
+#ifndef _SDT_HAS_SEMAPHORES
+#define _SDT_HAS_SEMAPHORES 1
+#endif
+#include <sys/sdt.h>
+
+/// weak: the header defines the semaphores in every translation unit including it
+#define CPPDIFACTORY_SEMAPHORE(name) \
+    unsigned short cppdifactory_##name##_semaphore __attribute__((weak, section(".probes"))) = 0
+
+CPPDIFACTORY_SEMAPHORE(get_instance_entry);
+CPPDIFACTORY_SEMAPHORE(get_instance_return);
+CPPDIFACTORY_SEMAPHORE(construct_entry);
+CPPDIFACTORY_SEMAPHORE(construct_return);
+CPPDIFACTORY_SEMAPHORE(singleton_create);
+CPPDIFACTORY_SEMAPHORE(singleton_expire);
+CPPDIFACTORY_SEMAPHORE(lock_acquire);
+CPPDIFACTORY_SEMAPHORE(lock_release);
+CPPDIFACTORY_SEMAPHORE(register_type);
+CPPDIFACTORY_SEMAPHORE(unregister_type);
+
+#define CPPDIFACTORY_PROBE_ENABLED(name)          __builtin_expect(cppdifactory_##name##_semaphore != 0, 0)
+#define CPPDIFACTORY_PROBE1(name, a1)             do { if (CPPDIFACTORY_PROBE_ENABLED(name)) DTRACE_PROBE1(cppdifactory, name, a1); } while (0)
+#define CPPDIFACTORY_PROBE2(name, a1, a2)         do { if (CPPDIFACTORY_PROBE_ENABLED(name)) DTRACE_PROBE2(cppdifactory, name, a1, a2); } while (0)
+#define CPPDIFACTORY_PROBE3(name, a1, a2, a3)     do { if (CPPDIFACTORY_PROBE_ENABLED(name)) DTRACE_PROBE3(cppdifactory, name, a1, a2, a3); } while (0)
+#else
+#define CPPDIFACTORY_PROBE_ENABLED(name)          false
+#define CPPDIFACTORY_PROBE1(name, a1)             do {} while (0)
+#define CPPDIFACTORY_PROBE2(name, a1, a2)         do {} while (0)
+#define CPPDIFACTORY_PROBE3(name, a1, a2, a3)     do {} while (0)
+#endif
+
+/// Start timestamp for the duration reported by probe name (0 if no tracer is attached).
+#define CPPDIFACTORY_PROBE_START(name)            (CPPDIFACTORY_PROBE_ENABLED(name) ? CppDiFactory::probeTimestamp() : uint64_t(0))
+
+namespace CppDiFactory
+{
+    /// Timestamp for probe durations in nanoseconds (always 0 without CPPDIFACTORY_USDT).
+    inline uint64_t probeTimestamp()
+    {
+#if defined(CPPDIFACTORY_USDT)
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+        return 0;
+#endif
+    }
+
+    /// Nanoseconds since start (see CPPDIFACTORY_PROBE_START), 0 if start was not taken.
+    inline uint64_t probeElapsed(uint64_t start)
+    {
+        return start ? probeTimestamp() - start : 0;
+    }
+
+    /// Mutex wrapper firing the lock_acquire and lock_release probes.
+    template <typename Mutex>
+    class ProbedMutex
+    {
+    public:
+        ProbedMutex(): _acquired(0) {}
+
+        ProbedMutex(const ProbedMutex&) = delete;
+        ProbedMutex& operator=(const ProbedMutex&) = delete;
+
+        void lock()
+        {
+            const uint64_t start = CPPDIFACTORY_PROBE_START(lock_acquire);
+            _mutex.lock();
+            _acquired = CPPDIFACTORY_PROBE_START(lock_release);
+            CPPDIFACTORY_PROBE1(lock_acquire, probeElapsed(start));
+            (void)start;
+        }
+
+        bool try_lock()
+        {
+            if (!_mutex.try_lock()){
+                return false;
+            }
+            _acquired = CPPDIFACTORY_PROBE_START(lock_release);
+            CPPDIFACTORY_PROBE1(lock_acquire, uint64_t(0));
+            return true;
+        }
+
+        void unlock()
+        {
+            const uint64_t held = CPPDIFACTORY_PROBE_ENABLED(lock_release) ? probeElapsed(_acquired) : 0;
+            _mutex.unlock();
+            CPPDIFACTORY_PROBE1(lock_release, held);
+            (void)held;
+        }
+
+    private:
+        Mutex _mutex;
+        uint64_t _acquired;
+    };
+} // namespace CppDiFactory
+
+#endif // PROBES_H
@@ -0,0 +1,314 @@
+#ifndef REACHABILITYINDEX_H
+#define REACHABILITYINDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace CppDiFactory
+{
+    /// Transitive closure of a dependency graph.
+    /// Building the index only stores the graph, its topological order and its
+    /// (weakly) connected components, in O(nodes + edges). The closure of a
+    /// component is computed when it is queried for the first time:
+    ///   - components up to denseLimit nodes: one bitset per node (built in
+    ///     topological order, combining the bitsets of the dependencies word by
+    ///     word), c * c / 8 bytes for c nodes
+    ///   - larger components: one sorted list of reachable nodes per node
+    /// Afterwards reachability queries do not traverse the graph:
+    ///   - dependsOn:       single bit test (binary search)
+    ///   - dependenciesOf:  scan of one bitset (copy of one list)
+    ///   - dependentsOf:    scan of one bit column (binary search per node) of the component
+    /// Queries are not thread safe (the closure is built by the first query).
+    class ReachabilityIndex
+    {
+    public:
+        explicit ReachabilityIndex(size_t denseLimit = 4096): _denseLimit(denseLimit) {}
+
+        /// Build the index.
+        /// \param nodes         ids of all nodes
+        /// \param dependencies  direct dependencies (ids) for each node, in the order of nodes.
+        ///                      Dependencies to unknown ids are ignored.
+        void build(const std::vector<size_t>& nodes, const std::vector<std::vector<size_t> >& dependencies)
+        {
+            const size_t count = nodes.size();
+
+            _ids = nodes;
+            _index.clear();
+            for (size_t i = 0; i < count; ++i){
+                _index[nodes[i]] = i;
+            }
+
+            _edges.assign(count, std::vector<size_t>());
+            for (size_t i = 0; i < count; ++i){
+                for (size_t dependency : dependencies[i]){
+                    auto it = _index.find(dependency);
+                    if (it != _index.end()){
+                        _edges[i].push_back(it->second);
+                    }
+                }
+            }
+
+            sortTopologically();
+            findComponents();
+        }
+
+        /// Check if node transitively depends on dependency.
+        bool dependsOn(size_t node, size_t dependency) const
+        {
+            auto from = _index.find(node);
+            auto to   = _index.find(dependency);
+            if (from == _index.end() || to == _index.end() ||
+                _componentOf[from->second] != _componentOf[to->second]){
+                return false;
+            }
+            const Component& component = closure(_componentOf[from->second]);
+            return component.reaches(_local[from->second], _local[to->second]);
+        }
+
+        /// Ids of all nodes the supplied node transitively depends on.
+        std::vector<size_t> dependenciesOf(size_t node) const
+        {
+            std::vector<size_t> result;
+            auto it = _index.find(node);
+            if (it == _index.end()){
+                return result;
+            }
+
+            const Component& component = closure(_componentOf[it->second]);
+            const size_t local = _local[it->second];
+            if (component.dense){
+                const uint64_t* row = component.row(local);
+                for (size_t w = 0; w < component.words; ++w){
+                    uint64_t word = row[w];
+                    while (word){
+                        const size_t bit = countTrailingZeros(word);
+                        result.push_back(_ids[component.nodes[w * 64 + bit]]);
+                        word &= word - 1;
+                    }
+                }
+            } else {
+                for (size_t reachable : component.sparse[local]){
+                    result.push_back(_ids[component.nodes[reachable]]);
+                }
+            }
+            return result;
+        }
+
+        /// Ids of all nodes which transitively depend on the supplied node.
+        std::vector<size_t> dependentsOf(size_t node) const
+        {
+            std::vector<size_t> result;
+            auto it = _index.find(node);
+            if (it == _index.end()){
+                return result;
+            }
+
+            const Component& component = closure(_componentOf[it->second]);
+            const size_t local = _local[it->second];
+            for (size_t i = 0; i < component.nodes.size(); ++i){
+                if (component.reaches(i, local)){
+                    result.push_back(_ids[component.nodes[i]]);
+                }
+            }
+            return result;
+        }
+
+        /// Ids of all nodes, dependencies before the nodes using them.
+        std::vector<size_t> topologicalOrder() const
+        {
+            std::vector<size_t> result;
+            result.reserve(_order.size());
+            for (size_t node : _order){
+                result.push_back(_ids[node]);
+            }
+            return result;
+        }
+
+        bool contains(size_t node) const
+        {
+            return _index.find(node) != _index.end();
+        }
+
+        /// Number of components whose closure has been computed.
+        size_t closedComponents() const
+        {
+            size_t count = 0;
+            for (const Component& component : _components){
+                count += component.closed ? 1 : 0;
+            }
+            return count;
+        }
+
+    private:
+        /// Connected nodes with their closure (local indices follow the topological order).
+        struct Component
+        {
+            Component(): closed(false), dense(true), words(0) {}
+
+            bool reaches(size_t node, size_t dependency) const
+            {
+                if (dense){
+                    return (row(node)[dependency / 64] >> (dependency % 64)) & 1;
+                }
+                return std::binary_search(sparse[node].begin(), sparse[node].end(), dependency);
+            }
+
+            uint64_t* row(size_t node)
+            {
+                return &bits[node * words];
+            }
+
+            const uint64_t* row(size_t node) const
+            {
+                return &bits[node * words];
+            }
+
+            /// global indices of the nodes
+            std::vector<size_t> nodes;
+            bool closed;
+            bool dense;
+            size_t words;
+            std::vector<uint64_t> bits;
+            std::vector<std::vector<size_t> > sparse;
+        };
+
+        void sortTopologically()
+        {
+            const size_t count = _ids.size();
+            std::vector<char> visited(count, 0);
+            std::vector<std::pair<size_t, size_t> > stack;
+
+            _order.clear();
+            _order.reserve(count);
+            for (size_t start = 0; start < count; ++start){
+                if (visited[start]){
+                    continue;
+                }
+                visited[start] = 1;
+                stack.push_back(std::make_pair(start, size_t(0)));
+                while (!stack.empty()){
+                    std::pair<size_t, size_t>& top = stack.back();
+                    if (top.second < _edges[top.first].size()){
+                        const size_t next = _edges[top.first][top.second++];
+                        if (!visited[next]){
+                            visited[next] = 1;
+                            stack.push_back(std::make_pair(next, size_t(0)));
+                        }
+                    } else {
+                        _order.push_back(top.first);
+                        stack.pop_back();
+                    }
+                }
+            }
+        }
+
+        void findComponents()
+        {
+            const size_t count = _ids.size();
+            std::vector<size_t> parent(count);
+            for (size_t i = 0; i < count; ++i){
+                parent[i] = i;
+            }
+            for (size_t i = 0; i < count; ++i){
+                for (size_t dependency : _edges[i]){
+                    parent[root(parent, i)] = root(parent, dependency);
+                }
+            }
+
+            _components.clear();
+            _componentOf.assign(count, 0);
+            _local.assign(count, 0);
+            std::unordered_map<size_t, size_t> componentOfRoot;
+            for (size_t node : _order){
+                auto it = componentOfRoot.insert(std::make_pair(root(parent, node), _components.size()));
+                if (it.second){
+                    _components.push_back(Component());
+                }
+                Component& component = _components[it.first->second];
+                _componentOf[node] = it.first->second;
+                _local[node] = component.nodes.size();
+                component.nodes.push_back(node);
+            }
+        }
+
+        static size_t root(std::vector<size_t>& parent, size_t node)
+        {
+            while (parent[node] != node){
+                parent[node] = parent[parent[node]];
+                node = parent[node];
+            }
+            return node;
+        }
+
+        /// Component with its closure (computed by the first query).
+        const Component& closure(size_t index) const
+        {
+            Component& component = _components[index];
+            if (component.closed){
+                return component;
+            }
+
+            const size_t count = component.nodes.size();
+            component.dense = count <= _denseLimit;
+            if (component.dense){
+                component.words = (count + 63) / 64;
+                component.bits.assign(count * component.words, 0);
+                for (size_t node = 0; node < count; ++node){
+                    uint64_t* row = component.row(node);
+                    for (size_t edge : _edges[component.nodes[node]]){
+                        const size_t dependency = _local[edge];
+                        const uint64_t* dependencyRow = component.row(dependency);
+                        for (size_t w = 0; w < component.words; ++w){
+                            row[w] |= dependencyRow[w];
+                        }
+                        row[dependency / 64] |= uint64_t(1) << (dependency % 64);
+                    }
+                }
+            } else {
+                component.sparse.assign(count, std::vector<size_t>());
+                for (size_t node = 0; node < count; ++node){
+                    std::vector<size_t>& reachable = component.sparse[node];
+                    for (size_t edge : _edges[component.nodes[node]]){
+                        const size_t dependency = _local[edge];
+                        reachable.push_back(dependency);
+                        reachable.insert(reachable.end(), component.sparse[dependency].begin(), component.sparse[dependency].end());
+                    }
+                    std::sort(reachable.begin(), reachable.end());
+                    reachable.erase(std::unique(reachable.begin(), reachable.end()), reachable.end());
+                }
+            }
+            component.closed = true;
+            return component;
+        }
+
+        static size_t countTrailingZeros(uint64_t word)
+        {
+#if defined(__GNUC__)
+            return static_cast<size_t>(__builtin_ctzll(word));
+#else
+            size_t count = 0;
+            while (!(word & 1)){
+                word >>= 1;
+                ++count;
+            }
+            return count;
+#endif
+        }
+
+        size_t _denseLimit;
+        std::vector<size_t> _ids;
+        std::unordered_map<size_t, size_t> _index;
+        std::vector<std::vector<size_t> > _edges;
+        std::vector<size_t> _order;
+        /// component and index within the component of each node
+        std::vector<size_t> _componentOf;
+        std::vector<size_t> _local;
+        mutable std::vector<Component> _components;
+    };
+} // namespace CppDiFactory
+
+#endif // REACHABILITYINDEX_H
@@ -0,0 +1,187 @@
+#ifndef REQUESTSCOPE_H
+#define REQUESTSCOPE_H
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
+namespace CppDiFactory
+{
+    class DiFactory;
+
+    /// Handle of one logical request spanning several calls of the DiFactory
+    /// (see DiFactory::beginRequest). All resolutions within the scope share the
+    /// SingleInstancePerRequest instances and the instances provided at request.
+    /// Copies of the handle refer to the same scope, so it can be captured by
+    /// callbacks and coroutines which continue the request on other threads.
+    /// The scope can also be activated for the current thread (see Activation):
+    /// DiFactory::getInstance then resolves within the active scope, so the handle
+    /// does not have to be passed through every function.
+    class RequestScope
+    {
+    public:
+        RequestScope() = default;
+
+        /// Check if this is a scope (and not an empty handle).
+        explicit operator bool() const
+        {
+            return static_cast<bool>(_state);
+        }
+
+        bool operator==(const RequestScope& other) const
+        {
+            return _state == other._state;
+        }
+
+        bool operator!=(const RequestScope& other) const
+        {
+            return _state != other._state;
+        }
+
+        /// Get an instance of T from the factory of the scope within the scope.
+        template <typename T>
+        std::shared_ptr<T> getInstance() const;
+
+        /// Scope active on the current thread (empty handle if none).
+        static RequestScope& current()
+        {
+            static thread_local RequestScope scope;
+            return scope;
+        }
+
+        class Activation;
+
+    private:
+        friend class DiFactory;
+
+        struct State
+        {
+            explicit State(DiFactory& factory): factory(factory) {}
+
+            DiFactory& factory;
+            /// instances of the request by type id (only used while the factory is locked)
+            std::unordered_map<size_t, std::shared_ptr<void> > instances;
+        };
+
+        explicit RequestScope(std::shared_ptr<State> state): _state(std::move(state)) {}
+
+        std::shared_ptr<State> _state;
+    };
+
+    /// Activates a scope on the current thread for its own lifetime
+    /// (the previously active scope is restored afterwards).
+    /// \note Coroutines may resume on another thread, use inScope for
+    ///       their co_await expressions.
+    class RequestScope::Activation
+    {
+    public:
+        explicit Activation(const RequestScope& scope): _scope(scope), _previous(current())
+        {
+            current() = scope;
+        }
+
+        ~Activation()
+        {
+            current() = std::move(_previous);
+        }
+
+        Activation(const Activation&) = delete;
+        Activation& operator=(const Activation&) = delete;
+
+    private:
+#if defined(__cpp_impl_coroutine)
+        template <typename Awaiter>
+        friend class ScopedAwaiter;
+#endif
+
+        /// Deactivate the scope on the current thread (the coroutine leaves it).
+        void suspend()
+        {
+            current() = std::move(_previous);
+        }
+
+        /// Activate the scope on the current thread (the coroutine continues on it).
+        void resume()
+        {
+            _previous = current();
+            current() = _scope;
+        }
+
+        RequestScope _scope;
+        /// scope active on the thread the activation currently runs on before it
+        RequestScope _previous;
+    };
+
+#if defined(__cpp_impl_coroutine)
+    /// Awaiter moving the activation of a coroutine along with it across a
+    /// suspension (see inScope).
+    template <typename Awaiter>
+    class ScopedAwaiter
+    {
+    public:
+        ScopedAwaiter(RequestScope::Activation& activation, Awaiter awaiter):
+            _activation(activation), _awaiter(std::move(awaiter)), _suspended(false) {}
+
+        bool await_ready()
+        {
+            return _awaiter.await_ready();
+        }
+
+        template <typename Promise>
+        decltype(auto) await_suspend(std::coroutine_handle<Promise> handle)
+        {
+            // the coroutine may be resumed on another thread as soon as it is handed over
+            _suspended = true;
+            _activation.suspend();
+            try {
+                return _awaiter.await_suspend(handle);
+            } catch (...) {
+                _suspended = false;
+                _activation.resume();
+                throw;
+            }
+        }
+
+        decltype(auto) await_resume()
+        {
+            if (_suspended){
+                _suspended = false;
+                _activation.resume();
+            }
+            return _awaiter.await_resume();
+        }
+
+    private:
+        RequestScope::Activation& _activation;
+        Awaiter _awaiter;
+        bool _suspended;
+    };
+
+    /// Await an awaiter within a coroutine having activated a scope. While the
+    /// coroutine is suspended, the suspending thread gets back the scope it had
+    /// before; the resuming thread gets the scope until the coroutine is suspended
+    /// again or ends (the activation then restores the previous scope of that thread).
+    /// \code
+    ///   Task<void> handle(CppDiFactory::RequestScope scope)
+    ///   {
+    ///       CppDiFactory::RequestScope::Activation activation(scope);
+    ///       auto data = co_await CppDiFactory::inScope(activation, socket.read());
+    ///       auto session = diFactory.getInstance<ISession>();   // shared within the request
+    ///       ...
+    ///   }
+    /// \endcode
+    template <typename Awaiter>
+    ScopedAwaiter<typename std::decay<Awaiter>::type> inScope(RequestScope::Activation& activation, Awaiter&& awaiter)
+    {
+        return ScopedAwaiter<typename std::decay<Awaiter>::type>(activation, std::forward<Awaiter>(awaiter));
+    }
+#endif
+} // namespace CppDiFactory
+
+#endif // REQUESTSCOPE_H
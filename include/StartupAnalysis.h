@@ -0,0 +1,156 @@
+#ifndef STARTUPANALYSIS_H
+#define STARTUPANALYSIS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CppDiFactory
+{
+    /// Measured construction time of a type (constructor and allocation only,
+    /// without resolving the dependencies).
+    struct ConstructionTime
+    {
+        size_t typeId;
+        std::string type;
+        size_t count;
+        std::chrono::nanoseconds totalTime;
+
+        std::chrono::nanoseconds averageTime() const
+        {
+            return count ? std::chrono::nanoseconds(totalTime.count() / static_cast<std::chrono::nanoseconds::rep>(count)) : std::chrono::nanoseconds(0);
+        }
+    };
+
+    /// Result of DiFactory::analyzeStartup.
+    /// Each type is counted once with its average construction time.
+    struct StartupReport
+    {
+        /// longest chain of sequentially dependent constructions, dependencies first
+        std::vector<ConstructionTime> criticalPath;
+        std::chrono::nanoseconds criticalPathTime;
+        /// sum of the construction times of all types
+        std::chrono::nanoseconds totalTime;
+        /// totalTime / criticalPathTime: speed-up if all independent constructions
+        /// were done in parallel (with unlimited threads)
+        double parallelSpeedUp;
+        /// all measured types, most expensive first
+        std::vector<ConstructionTime> types;
+    };
+
+    /// Records construction times per type.
+    class ConstructionTimer
+    {
+    public:
+        ConstructionTimer(): _enabled(false) {}
+
+        void enable(bool enable)
+        {
+            _enabled.store(enable, std::memory_order_relaxed);
+        }
+
+        bool enabled() const
+        {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        void record(size_t typeId, std::chrono::nanoseconds duration)
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            Entry& entry = _entries[typeId];
+            ++entry.count;
+            entry.totalTime += duration;
+        }
+
+        /// Average construction time of a type (zero if it was not measured).
+        std::chrono::nanoseconds averageTime(size_t typeId) const
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            const auto it = _entries.find(typeId);
+            if (it == _entries.end()){
+                return std::chrono::nanoseconds(0);
+            }
+            return std::chrono::nanoseconds(it->second.totalTime.count() / static_cast<std::chrono::nanoseconds::rep>(it->second.count));
+        }
+
+        /// Measured times (the type names are not filled in).
+        std::vector<ConstructionTime> times() const
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+
+            std::vector<ConstructionTime> result;
+            for (const auto& it : _entries){
+                result.push_back(ConstructionTime{ it.first, std::string(), it.second.count, it.second.totalTime });
+            }
+            return result;
+        }
+
+        void reset()
+        {
+            std::lock_guard<std::mutex> lockGuard{ _mutex };
+            _entries.clear();
+        }
+
+    private:
+        struct Entry
+        {
+            Entry(): count(0), totalTime(0) {}
+
+            size_t count;
+            std::chrono::nanoseconds totalTime;
+        };
+
+        std::atomic<bool> _enabled;
+        mutable std::mutex _mutex;
+        std::unordered_map<size_t, Entry> _entries;
+    };
+
+    /// Longest path through a dependency graph weighted by the construction time of the nodes.
+    /// \param order         node ids, dependencies before the nodes using them
+    /// \param dependencies  direct dependencies of each node (in the order of order)
+    /// \param selfTime      construction time of each node (in the order of order)
+    /// \return node ids of the longest path, dependencies first
+    inline std::vector<size_t> longestPath(const std::vector<size_t>& order,
+                                           const std::vector<std::vector<size_t> >& dependencies,
+                                           const std::vector<std::chrono::nanoseconds>& selfTime)
+    {
+        std::unordered_map<size_t, size_t> index;
+        for (size_t i = 0; i < order.size(); ++i){
+            index[order[i]] = i;
+        }
+
+        // finish[i]: time at which node i is ready if everything runs as early as possible
+        std::vector<std::chrono::nanoseconds> finish(order.size(), std::chrono::nanoseconds(0));
+        std::vector<size_t> predecessor(order.size(), order.size());
+        size_t last = order.size();
+        for (size_t i = 0; i < order.size(); ++i){
+            for (size_t dependency : dependencies[i]){
+                const auto it = index.find(dependency);
+                if (it != index.end() && it->second < i && finish[it->second] > finish[i]){
+                    finish[i] = finish[it->second];
+                    predecessor[i] = it->second;
+                }
+            }
+            finish[i] += selfTime[i];
+            if (last == order.size() || finish[i] > finish[last]){
+                last = i;
+            }
+        }
+
+        std::vector<size_t> path;
+        for (size_t node = last; node < order.size(); node = predecessor[node]){
+            path.push_back(order[node]);
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+} // namespace CppDiFactory
+
+#endif // STARTUPANALYSIS_H
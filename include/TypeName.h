@@ -0,0 +1,30 @@
+#ifndef TYPENAME_H
+#define TYPENAME_H
+
+#include <cstdlib>
+#include <string>
+#include <typeinfo>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace CppDiFactory
+{
+    /// Readable name of a type (demangled where supported), e.g. for diagnostics.
+    inline std::string typeName(const std::type_info& type)
+    {
+#if defined(__GNUG__)
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+        if (status == 0 && demangled){
+            std::string result(demangled);
+            std::free(demangled);
+            return result;
+        }
+#endif
+        return type.name();
+    }
+} // namespace CppDiFactory
+
+#endif // TYPENAME_H
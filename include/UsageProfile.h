@@ -0,0 +1,60 @@
+#ifndef USAGEPROFILE_H
+#define USAGEPROFILE_H
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace CppDiFactory
+{
+    /// File listing the types requested during a run (one type name per line),
+    /// used to warm up the next run (see DiFactory::warmUp).
+    class UsageProfile
+    {
+    public:
+        /// \return false if the file does not exist or is not a usage profile
+        static bool load(const std::string& path, std::vector<std::string>& types)
+        {
+            std::ifstream file(path.c_str());
+            std::string line;
+            if (!std::getline(file, line) || line != header()){
+                return false;
+            }
+
+            types.clear();
+            while (std::getline(file, line)){
+                if (!line.empty()){
+                    types.push_back(line);
+                }
+            }
+            return true;
+        }
+
+        /// Store the type names (replaces the file atomically).
+        static bool store(const std::string& path, const std::vector<std::string>& types)
+        {
+            const std::string temporary = path + ".tmp";
+            {
+                std::ofstream file(temporary.c_str(), std::ios::trunc);
+                file << header() << '\n';
+                for (const std::string& type : types){
+                    file << type << '\n';
+                }
+                if (!file.flush()){
+                    std::remove(temporary.c_str());
+                    return false;
+                }
+            }
+            return std::rename(temporary.c_str(), path.c_str()) == 0;
+        }
+
+    private:
+        static const char* header()
+        {
+            return "CppDiFactory usage profile 1";
+        }
+    };
+} // namespace CppDiFactory
+
+#endif // USAGEPROFILE_H
@@ -0,0 +1,121 @@
+#ifndef VALIDATIONCACHE_H
+#define VALIDATIONCACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace CppDiFactory
+{
+    /// Stable fingerprint (64 bit FNV-1a) of a set of registrations.
+    /// Only stable keys (e.g. type names, no addresses) must be added,
+    /// so the fingerprint is the same in every run of the same program.
+    class RegistryFingerprint
+    {
+    public:
+        RegistryFingerprint(): _hash(14695981039346656037ULL) {}
+
+        void add(const std::string& text)
+        {
+            for (unsigned char c : text){
+                addByte(c);
+            }
+            addByte(0);
+        }
+
+        void add(uint64_t value)
+        {
+            for (int i = 0; i < 8; ++i){
+                addByte(static_cast<unsigned char>(value >> (i * 8)));
+            }
+        }
+
+        uint64_t value() const
+        {
+            return _hash;
+        }
+
+        /// Scramble a hash (splitmix64 finalizer), so sums of hashes do not depend
+        /// on the order in which they are added.
+        static uint64_t mix(uint64_t value)
+        {
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+            return value ^ (value >> 31);
+        }
+
+    private:
+        void addByte(unsigned char c)
+        {
+            _hash = (_hash ^ c) * 1099511628211ULL;
+        }
+
+        uint64_t _hash;
+    };
+
+    /// Validation result of one registered type.
+    struct ValidationCacheEntry
+    {
+        std::string type;           ///< mangled type name (std::type_info::name)
+        bool hasSiprDependency;
+    };
+
+    /// File storing the validation results of a set of registrations, keyed by
+    /// the fingerprint of the registrations.
+    /// The file is a text file with the fingerprint in the first line and
+    /// one line per type ("<SIPR flag> <mangled type name>").
+    class ValidationCache
+    {
+    public:
+        /// Load the entries of the cache file.
+        /// \return false if the file does not exist or belongs to another fingerprint
+        static bool load(const std::string& path, uint64_t fingerprint, std::vector<ValidationCacheEntry>& entries)
+        {
+            std::ifstream file(path.c_str());
+            std::string line;
+            if (!std::getline(file, line) || line != header(fingerprint)){
+                return false;
+            }
+
+            entries.clear();
+            while (std::getline(file, line)){
+                if (line.size() < 3 || (line[0] != '0' && line[0] != '1') || line[1] != ' '){
+                    return false;
+                }
+                entries.push_back(ValidationCacheEntry{ line.substr(2), line[0] == '1' });
+            }
+            return true;
+        }
+
+        /// Store the entries (replaces the file atomically).
+        static bool store(const std::string& path, uint64_t fingerprint, const std::vector<ValidationCacheEntry>& entries)
+        {
+            const std::string temporary = path + ".tmp";
+            {
+                std::ofstream file(temporary.c_str(), std::ios::trunc);
+                file << header(fingerprint) << '\n';
+                for (const ValidationCacheEntry& entry : entries){
+                    file << (entry.hasSiprDependency ? '1' : '0') << ' ' << entry.type << '\n';
+                }
+                if (!file.flush()){
+                    std::remove(temporary.c_str());
+                    return false;
+                }
+            }
+            return std::rename(temporary.c_str(), path.c_str()) == 0;
+        }
+
+    private:
+        static std::string header(uint64_t fingerprint)
+        {
+            std::ostringstream stream;
+            stream << "CppDiFactory validation cache 2 " << std::hex << fingerprint;
+            return stream.str();
+        }
+    };
+} // namespace CppDiFactory
+
+#endif // VALIDATIONCACHE_H
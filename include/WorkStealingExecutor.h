@@ -0,0 +1,195 @@
+#ifndef WORKSTEALINGEXECUTOR_H
+#define WORKSTEALINGEXECUTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "Executor.h"
+
+namespace CppDiFactory
+{
+    /// Thread pool with one task queue per worker thread.
+    /// Tasks scheduled from a worker thread are added to the queue of that
+    /// worker (and run in LIFO order, while the data they use is still in the
+    /// cache), other tasks are distributed round robin. Idle workers steal the
+    /// oldest tasks from the queues of other workers.
+    /// The destructor runs all remaining tasks before the workers are stopped.
+    class WorkStealingExecutor: public Executor
+    {
+    public:
+        /// \param threadCount  number of worker threads (0: one per hardware thread)
+        /// \param cpus         CPUs to pin the workers to (worker i is pinned to
+        ///                     cpus[i % cpus.size()]), empty: no pinning
+        WorkStealingExecutor(size_t threadCount = 0, const std::vector<int>& cpus = std::vector<int>()):
+            _pending(0), _sleeping(0), _next(0), _stop(false)
+        {
+            if (threadCount == 0){
+                threadCount = std::max(1u, std::thread::hardware_concurrency());
+            }
+
+            for (size_t i = 0; i < threadCount; ++i){
+                _workers.push_back(std::unique_ptr<Worker>(new Worker()));
+            }
+            for (size_t i = 0; i < threadCount; ++i){
+                const int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+                _workers[i]->thread = std::thread([this, i, cpu]() { run(i, cpu); });
+            }
+        }
+
+        virtual ~WorkStealingExecutor()
+        {
+            {
+                std::lock_guard<std::mutex> lockGuard{ _sleepMutex };
+                _stop = true;
+            }
+            _wakeUp.notify_all();
+
+            for (auto& worker : _workers){
+                worker->thread.join();
+            }
+        }
+
+        WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+        WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+        virtual void execute(std::function<void()> task) override
+        {
+            const Context& current = context();
+            Worker& worker = current.executor == this
+                           ? *_workers[current.index]
+                           : *_workers[_next.fetch_add(1, std::memory_order_relaxed) % _workers.size()];
+            {
+                std::lock_guard<std::mutex> lockGuard{ worker.mutex };
+                worker.tasks.push_back(std::move(task));
+            }
+            // count the task after queueing it, so a worker seeing _pending > 0 finds it
+            // (or another worker took it and is about to decrement _pending)
+            _pending.fetch_add(1);
+            if (_sleeping.load() > 0){
+                // a worker sleeps (or is about to): lock to not notify between its check and its wait
+                std::lock_guard<std::mutex> lockGuard{ _sleepMutex };
+                _wakeUp.notify_one();
+            }
+        }
+
+        virtual bool runsInCurrentThread() const override
+        {
+            return context().executor == this;
+        }
+
+        size_t threadCount() const
+        {
+            return _workers.size();
+        }
+
+    private:
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()> > tasks;
+            std::thread thread;
+        };
+
+        struct Context
+        {
+            const WorkStealingExecutor* executor;
+            size_t index;
+        };
+
+        static Context& context()
+        {
+            static thread_local Context current{ nullptr, 0 };
+            return current;
+        }
+
+        void run(size_t index, int cpu)
+        {
+#if defined(__linux__)
+            if (cpu >= 0){
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                CPU_SET(cpu, &cpus);
+                pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            }
+#else
+            (void)cpu;
+#endif
+            context().executor = this;
+            context().index = index;
+
+            while (true){
+                std::function<void()> task;
+                if (take(index, task)){
+                    _pending.fetch_sub(1);
+                    task();
+                    continue;
+                }
+                if (_pending.load() > 0){
+                    // the task is taken by another worker which has not decremented _pending yet
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                // only idle workers use the mutex: announce the sleep before checking _pending,
+                // execute() counts the task before checking _sleeping, so one of both sees the other
+                std::unique_lock<std::mutex> lock{ _sleepMutex };
+                if (_stop && _pending.load() == 0){
+                    return;
+                }
+                _sleeping.fetch_add(1);
+                _wakeUp.wait(lock, [this]() { return _pending.load() > 0 || _stop; });
+                _sleeping.fetch_sub(1);
+            }
+        }
+
+        /// Take the newest own task or steal the oldest task of another worker.
+        bool take(size_t index, std::function<void()>& task)
+        {
+            {
+                Worker& own = *_workers[index];
+                std::lock_guard<std::mutex> lockGuard{ own.mutex };
+                if (!own.tasks.empty()){
+                    task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    return true;
+                }
+            }
+
+            for (size_t i = 1; i < _workers.size(); ++i){
+                Worker& victim = *_workers[(index + i) % _workers.size()];
+                std::lock_guard<std::mutex> lockGuard{ victim.mutex };
+                if (!victim.tasks.empty()){
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector<std::unique_ptr<Worker> > _workers;
+        std::mutex _sleepMutex;
+        std::condition_variable _wakeUp;
+        /// queued tasks and sleeping workers (only the sleep itself is guarded by _sleepMutex)
+        std::atomic<size_t> _pending;
+        std::atomic<size_t> _sleeping;
+        std::atomic<size_t> _next;
+        /// guarded by _sleepMutex
+        bool _stop;
+    };
+} // namespace CppDiFactory
+
+#endif // WORKSTEALINGEXECUTOR_H
@@ -4,3 +4,28 @@
 //#include "testCase1.h"
 #include "testCaseRegistration.h"
 #include "testCaseSingleton.h"
+#include "testCaseLongLivedRegion.h"
+#include "testCaseConstructOn.h"
+#include "testCaseReachability.h"
+#include "testCaseRefreshing.h"
+#include "testCaseConstructionLimit.h"
+#include "testCaseMappedImage.h"
+#include "testCaseNumaReplicas.h"
+#include "testCaseExecutor.h"
+#include "testCaseCallSites.h"
+#include "testCaseMemoryPressure.h"
+#include "testCaseComposite.h"
+#include "testCaseCaptiveDependencies.h"
+#include "testCaseValidationCache.h"
+#include "testCaseStartupAnalysis.h"
+#include "testCaseInterceptor.h"
+#include "testCaseWarmUp.h"
+#include "testCaseDifferential.h"
+#include "testCaseRebuild.h"
+#include "testCaseRequestScope.h"
+#include "testCaseCoroutineScope.h"
+#include "testCaseUnique.h"
+#include "testCaseLifetimeAdvisor.h"
+#include "testCaseFrozenRegistry.h"
+#include "testCaseFlatCombining.h"
+#include "testCaseLifetimeGroup.h"
@@ -0,0 +1,66 @@
+#ifndef TESTCASECALLSITES_H
+#define TESTCASECALLSITES_H
+
+#include <string>
+#include <type_traits>
+
+#include "CppDiFactory.h"
+
+namespace testCaseCallSites
+{
+
+class IScrew
+{
+public:
+    virtual ~IScrew() = default;
+};
+
+class Screw : public IScrew
+{
+};
+
+class Engine
+{
+public:
+    Engine(std::shared_ptr<IScrew>) {}
+};
+
+TEST_CASE( "CallSites: requests are aggregated per call site", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Screw>().withInterfaces<IScrew>();
+    myFactory.registerClass<Engine, IScrew>();
+
+    // not recorded while disabled
+    myFactory.getInstance<IScrew>(CPPDIFACTORY_CALL_SITE);
+    CHECK(myFactory.callSiteStatistics().empty());
+
+    myFactory.enableCallSiteStatistics();
+
+    for (int i = 0; i < 10; ++i){
+        myFactory.getInstance<Engine>(CPPDIFACTORY_CALL_SITE);
+    }
+    myFactory.getInstance<IScrew>(CppDiFactory::CallSite("tagged"));
+    // tags are compared by value, the temporary string is copied
+    myFactory.getInstance<IScrew>(CppDiFactory::CallSite(std::string("tag") + "ged"));
+
+    const std::vector<CppDiFactory::CallSiteStatistics> statistics = myFactory.callSiteStatistics();
+    REQUIRE(statistics.size() == 2);
+
+    size_t loopIndex = statistics[0].tag.empty() ? 0 : 1;
+    CHECK(statistics[loopIndex].count == 10);
+    CHECK(statistics[loopIndex].file.find("testCaseCallSites.h") != std::string::npos);
+    CHECK(statistics[loopIndex].line > 0);
+    CHECK(statistics[1 - loopIndex].tag == "tagged");
+    CHECK(statistics[1 - loopIndex].count == 2);
+
+    // a tag has to be named explicitly
+    CHECK((!std::is_convertible<const char*, CppDiFactory::CallSite>::value));
+
+    myFactory.resetCallSiteStatistics();
+    CHECK(myFactory.callSiteStatistics().empty());
+}
+
+}
+
+#endif // TESTCASECALLSITES_H
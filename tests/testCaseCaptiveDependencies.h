@@ -0,0 +1,119 @@
+#ifndef TESTCASECAPTIVEDEPENDENCIES_H
+#define TESTCASECAPTIVEDEPENDENCIES_H
+
+#include <string>
+#include <vector>
+
+#include "CppDiFactory.h"
+
+namespace testCaseCaptiveDependencies
+{
+
+class IBuffer
+{
+public:
+    virtual ~IBuffer() = default;
+};
+
+class Buffer : public IBuffer
+{
+};
+
+class Config
+{
+};
+
+class Cache
+{
+public:
+    Cache(std::shared_ptr<IBuffer> buffer, std::shared_ptr<Config> config): _buffer(buffer), _config(config) {}
+
+    std::shared_ptr<IBuffer> _buffer;
+    std::shared_ptr<Config> _config;
+};
+
+class Handler
+{
+public:
+    Handler(std::shared_ptr<IBuffer> buffer): _buffer(buffer) {}
+
+    std::shared_ptr<IBuffer> _buffer;
+};
+
+TEST_CASE( "CaptiveDependencies: registration kinds", "" ){
+
+    using CppDiFactory::RegistrationKind;
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Buffer>().withInterfaces<IBuffer>();
+    myFactory.registerSingleton<Config>();
+
+    CHECK(myFactory.registrationKind<Buffer>() == RegistrationKind::Class);
+    CHECK(myFactory.registrationKind<IBuffer>() == RegistrationKind::Interface);
+    CHECK(myFactory.registrationKind<Config>() == RegistrationKind::Singleton);
+    CHECK(CppDiFactory::lifetimeOf(RegistrationKind::Class) < CppDiFactory::lifetimeOf(RegistrationKind::Singleton));
+}
+
+TEST_CASE( "CaptiveDependencies: singleton capturing a transient type", "" ){
+
+    using CppDiFactory::Lifetime;
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Buffer>().withInterfaces<IBuffer>();
+    myFactory.registerSingleton<Config>();
+    myFactory.registerSingleton<Cache, IBuffer, Config>();
+    myFactory.registerClass<Handler, IBuffer>();
+
+    std::vector<std::string> reported;
+    myFactory.setCaptiveDependencyPolicy(CppDiFactory::CaptiveDependencyPolicy::Report,
+                                         [&](const CppDiFactory::CaptiveDependency& captive) { reported.push_back(captive.describe()); });
+
+    // Report: the request succeeds
+    CHECK(myFactory.getInstance<Cache>());
+    REQUIRE(reported.size() == 1);
+    CHECK(reported[0].find("Cache -> testCaseCaptiveDependencies::IBuffer -> testCaseCaptiveDependencies::Buffer") != std::string::npos);
+
+    const auto captives = myFactory.captiveDependencies();
+    REQUIRE(captives.size() == 1);
+    CHECK(captives[0].holder == CppDiFactory::type_id<Cache>());
+    CHECK(captives[0].captive == CppDiFactory::type_id<Buffer>());
+    CHECK(captives[0].holderLifetime == Lifetime::Singleton);
+    CHECK(captives[0].captiveLifetime == Lifetime::Transient);
+    CHECK(captives[0].path.size() == 3);
+
+    // reported once per change of the registrations
+    myFactory.getInstance<Handler>();
+    CHECK(reported.size() == 1);
+}
+
+TEST_CASE( "CaptiveDependencies: reject", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Buffer>().withInterfaces<IBuffer>();
+    myFactory.registerSingleton<Config>();
+    myFactory.registerSingleton<Cache, IBuffer, Config>();
+    myFactory.setCaptiveDependencyPolicy(CppDiFactory::CaptiveDependencyPolicy::Reject);
+
+    CHECK_THROWS(myFactory.validate());
+    CHECK_THROWS(myFactory.getInstance<Config>());
+
+    // fixed by registering the buffer as singleton
+    myFactory.registerSingleton<Buffer>();
+    CHECK_NOTHROW(myFactory.validate());
+    CHECK(myFactory.captiveDependencies().empty());
+}
+
+TEST_CASE( "CaptiveDependencies: permanent instance capturing a singleton", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerSingleton<Buffer>().withInterfaces<IBuffer>();
+    myFactory.registerSingleton<Config>();
+    myFactory.registerRefreshing<Cache, IBuffer, Config>(std::chrono::hours(1));
+
+    const auto captives = myFactory.captiveDependencies();
+    CHECK(captives.size() == 2);
+}
+
+} // namespace testCaseCaptiveDependencies
+
+#endif // TESTCASECAPTIVEDEPENDENCIES_H
@@ -0,0 +1,110 @@
+#ifndef TESTCASECOMPOSITE_H
+#define TESTCASECOMPOSITE_H
+
+#include "CppDiFactory.h"
+
+namespace testCaseComposite
+{
+
+using CppDiFactory::Component;
+using CppDiFactory::Composite;
+
+class IStage
+{
+public:
+    virtual int process(int value) = 0;
+    virtual ~IStage() = default;
+};
+
+class Decoder : public IStage
+{
+public:
+    virtual int process(int value) override
+    {
+        return value + 1;
+    }
+};
+
+class Filter : public IStage
+{
+public:
+    Filter(Decoder& decoder): _decoder(decoder) {}
+
+    virtual int process(int value) override
+    {
+        return _decoder.process(value) * 2;
+    }
+
+    Decoder& _decoder;
+};
+
+class Router
+{
+public:
+    Router(Filter& filter, Decoder& decoder): _filter(filter), _decoder(decoder) {}
+
+    int route(int value)
+    {
+        return _filter.process(value);
+    }
+
+    Filter& _filter;
+    Decoder& _decoder;
+};
+
+class Sink
+{
+public:
+    Sink(IStage& stage): _stage(stage) {}
+
+    IStage& _stage;
+};
+
+using Pipeline = Composite<Component<Decoder>,
+                           Component<Filter, Decoder>,
+                           Component<Router, Filter, Decoder> >;
+
+TEST_CASE( "Composite: members are wired by reference", "" ){
+
+    Pipeline pipeline;
+
+    Router& router = pipeline.root();
+    CHECK(&router == &pipeline.get<Router>());
+    CHECK(&router._filter == &pipeline.get<Filter>());
+    CHECK(&router._decoder == &pipeline.get<Decoder>());
+    CHECK(&pipeline.get<Filter>()._decoder == &pipeline.get<Decoder>());
+    CHECK(router.route(1) == 4);
+
+    // all members are stored within the composite
+    const char* begin = reinterpret_cast<const char*>(&pipeline);
+    const char* member = reinterpret_cast<const char*>(&pipeline.get<Filter>());
+    CHECK(member >= begin);
+    CHECK(member < begin + sizeof(Pipeline));
+}
+
+TEST_CASE( "Composite: interface dependencies", "" ){
+
+    Composite<Component<Decoder>, Component<Sink, IStage> > composite;
+
+    CHECK(&composite.root()._stage == &composite.get<Decoder>());
+    CHECK(&composite.get<IStage>() == &composite.get<Decoder>());
+}
+
+TEST_CASE( "Composite: registered root", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerComposite<Pipeline>();
+
+    std::weak_ptr<Router> weakRouter;
+    {
+        auto router = myFactory.getInstance<Router>();
+        CHECK(router->route(2) == 6);
+        CHECK(router != myFactory.getInstance<Router>());
+        weakRouter = router;
+    }
+    CHECK(weakRouter.expired());
+}
+
+} // namespace testCaseComposite
+
+#endif // TESTCASECOMPOSITE_H
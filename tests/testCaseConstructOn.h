@@ -0,0 +1,198 @@
+#ifndef TESTCASECONSTRUCTON_H
+#define TESTCASECONSTRUCTON_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <thread>
+
+#include "CppDiFactory.h"
+
+namespace testCaseConstructOn
+{
+
+/// Simple event loop running all tasks on a single thread.
+class EventLoop : public CppDiFactory::Executor
+{
+public:
+    EventLoop(): _stop(false), _thread([this]() { run(); }) {}
+
+    ~EventLoop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _condition.notify_one();
+        _thread.join();
+    }
+
+    virtual void execute(std::function<void()> task) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push_back(task);
+        }
+        _condition.notify_one();
+    }
+
+    virtual bool runsInCurrentThread() const override
+    {
+        return std::this_thread::get_id() == _thread.get_id();
+    }
+
+    std::thread::id threadId() const
+    {
+        return _thread.get_id();
+    }
+
+    size_t queued()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _tasks.size();
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true){
+            _condition.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+            if (_tasks.empty()){
+                return;
+            }
+            std::function<void()> task = _tasks.front();
+            _tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<std::function<void()> > _tasks;
+    bool _stop;
+    std::thread _thread;
+};
+
+class IConnection
+{
+public:
+    virtual std::thread::id constructedOn() const = 0;
+    virtual ~IConnection() = default;
+};
+
+class Connection : public IConnection
+{
+public:
+    Connection(): _constructedOn(std::this_thread::get_id()) {}
+
+    virtual std::thread::id constructedOn() const override
+    {
+        return _constructedOn;
+    }
+
+private:
+    std::thread::id _constructedOn;
+};
+
+class Client
+{
+public:
+    Client(std::shared_ptr<IConnection> connection):
+        _connection(connection), _constructedOn(std::this_thread::get_id())
+    {}
+
+    std::shared_ptr<IConnection> _connection;
+    std::thread::id _constructedOn;
+};
+
+class Broken
+{
+public:
+    Broken() { throw std::runtime_error("broken"); }
+};
+
+TEST_CASE( "ConstructOn: instance is constructed on the executor", "" ){
+
+    auto loop = std::make_shared<EventLoop>();
+    CppDiFactory::DiFactory myFactory;
+
+    myFactory.registerSingleton<Connection>().constructOn(loop).withInterfaces<IConnection>();
+    myFactory.registerClass<Client, IConnection>();
+
+    auto client = myFactory.getInstance<Client>();
+
+    CHECK(client->_connection->constructedOn() == loop->threadId());
+    CHECK(client->_constructedOn == std::this_thread::get_id());
+}
+
+TEST_CASE( "ConstructOn: asynchronous request", "" ){
+
+    auto loop = std::make_shared<EventLoop>();
+    CppDiFactory::DiFactory myFactory;
+
+    myFactory.registerClass<Connection>().withInterfaces<IConnection>().constructOn(loop);
+
+    auto connection = myFactory.getInstanceAsync<IConnection>();
+
+    CHECK(connection.get()->constructedOn() == loop->threadId());
+}
+
+TEST_CASE( "ConstructOn: asynchronous and synchronous requests do not block each other", "" ){
+
+    auto loop = std::make_shared<EventLoop>();
+    CppDiFactory::DiFactory myFactory;
+
+    myFactory.registerClass<Connection>().constructOn(loop);
+
+    // keep the loop busy, so both requests queue their work behind this task
+    std::promise<void> running;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    loop->execute([&running, released]() {
+        running.set_value();
+        released.wait();
+    });
+    running.get_future().wait();
+
+    auto async = myFactory.getInstanceAsync<Connection>();
+    std::shared_ptr<Connection> sync;
+    std::thread requester([&]() { sync = myFactory.getInstance<Connection>(); });
+
+    for (int i = 0; i < 200 && loop->queued() < 2; ++i){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    release.set_value();
+
+    REQUIRE(async.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    requester.join();
+    CHECK(async.get()->constructedOn() == loop->threadId());
+    CHECK(sync->constructedOn() == loop->threadId());
+}
+
+TEST_CASE( "ConstructOn: constructor errors are passed to the requesting thread", "" ){
+
+    auto loop = std::make_shared<EventLoop>();
+    CppDiFactory::DiFactory myFactory;
+
+    myFactory.registerClass<Broken>().constructOn(loop);
+
+    CHECK_THROWS(myFactory.getInstance<Broken>());
+    CHECK_THROWS(myFactory.getInstanceAsync<Broken>().get());
+    CHECK_THROWS(myFactory.getInstanceAsync<Connection>().get());
+}
+
+TEST_CASE( "ConstructOn: not allowed for instances", "" ){
+
+    auto loop = std::make_shared<EventLoop>();
+    CppDiFactory::DiFactory myFactory;
+
+    CHECK_THROWS(myFactory.registerInstance(std::make_shared<Connection>()).constructOn(loop));
+}
+
+}
+
+#endif // TESTCASECONSTRUCTON_H
@@ -0,0 +1,113 @@
+#ifndef TESTCASECONSTRUCTIONLIMIT_H
+#define TESTCASECONSTRUCTIONLIMIT_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "CppDiFactory.h"
+
+namespace testCaseConstructionLimit
+{
+
+class Parser
+{
+public:
+    Parser() {}
+};
+
+std::atomic<bool> indexBuilding(false);
+
+class SearchIndex
+{
+public:
+    SearchIndex()
+    {
+        indexBuilding = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        indexBuilding = false;
+    }
+};
+
+TEST_CASE( "ConstructionLimit: limiter bounds simultaneous constructions", "" ){
+
+    CppDiFactory::ConstructionLimiter limiter(2);
+    std::atomic<int> active(0);
+    std::atomic<int> maxActive(0);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i){
+        threads.push_back(std::thread([&]() {
+            for (int j = 0; j < 20; ++j){
+                limiter.acquire();
+                int current = ++active;
+                int max = maxActive;
+                while (current > max && !maxActive.compare_exchange_weak(max, current)){
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                --active;
+                limiter.release();
+            }
+        }));
+    }
+    for (auto& thread : threads){
+        thread.join();
+    }
+
+    CHECK(maxActive <= 2);
+    CHECK(active == 0);
+}
+
+TEST_CASE( "ConstructionLimit: waiting for a slot times out", "" ){
+
+    CppDiFactory::ConstructionLimiter limiter(1, std::chrono::milliseconds(10));
+
+    CHECK(limiter.acquire());
+    CHECK(!limiter.acquire());
+
+    limiter.release();
+    CHECK(limiter.acquire());
+    limiter.release();
+}
+
+TEST_CASE( "ConstructionLimit: registration", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+
+    myFactory.registerClass<Parser>().maxConcurrentConstructions(1, std::chrono::seconds(1));
+    CHECK_NOTHROW(myFactory.getInstance<Parser>());
+    CHECK_NOTHROW(myFactory.getInstance<Parser>());
+
+    myFactory.registerSingleton<SearchIndex>().maxConcurrentConstructions(1);
+    CHECK_NOTHROW(myFactory.getInstance<SearchIndex>());
+
+    CHECK_THROWS(myFactory.registerInstance(std::make_shared<Parser>()).maxConcurrentConstructions(1));
+    CHECK_THROWS(myFactory.registerClass<Parser>().maxConcurrentConstructions(0));
+}
+
+TEST_CASE( "ConstructionLimit: refreshes wait for a slot outside of the factory lock", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerRefreshing<SearchIndex>(std::chrono::seconds(0)).maxConcurrentConstructions(1, std::chrono::milliseconds(10));
+    myFactory.registerClass<Parser>();
+    auto index = myFactory.getInstance<SearchIndex>();
+
+    std::thread refreshing([&myFactory]() { myFactory.refresh<SearchIndex>(); });
+    while (!indexBuilding){
+        std::this_thread::yield();
+    }
+
+    // the slot is taken by the running refresh
+    CHECK_THROWS(myFactory.refresh<SearchIndex>());
+    // requests are not blocked meanwhile
+    CHECK(myFactory.getInstance<Parser>());
+    CHECK(indexBuilding);
+
+    refreshing.join();
+    CHECK(myFactory.getInstance<SearchIndex>() != index);
+}
+
+}
+
+#endif // TESTCASECONSTRUCTIONLIMIT_H
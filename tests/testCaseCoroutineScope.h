@@ -0,0 +1,152 @@
+#ifndef TESTCASECOROUTINESCOPE_H
+#define TESTCASECOROUTINESCOPE_H
+
+// Only built with C++20 (see target MainTestCpp20 in the Makefile)
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <exception>
+#include <string>
+#include <thread>
+
+#include "CppDiFactory.h"
+
+namespace testCaseCoroutineScope
+{
+
+class Tenant
+{
+public:
+    Tenant(const std::string& name): _name(name) {}
+
+    std::string _name;
+};
+
+class Session
+{
+public:
+    Session(std::shared_ptr<Tenant> tenant): _tenant(tenant) {}
+
+    std::shared_ptr<Tenant> _tenant;
+};
+
+/// Coroutine running eagerly until its first suspension, nobody waits for it.
+struct Task
+{
+    struct promise_type
+    {
+        Task get_return_object() { return Task(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+/// Hands the suspended coroutine over to be resumed by the test (unless ready).
+struct Suspension
+{
+    bool ready;
+    std::coroutine_handle<>* resumeLater;
+
+    bool await_ready() { return ready; }
+    void await_suspend(std::coroutine_handle<> handle) { *resumeLater = handle; }
+    int await_resume() { return 42; }
+};
+
+struct Observed
+{
+    CppDiFactory::RequestScope beforeAwait;
+    CppDiFactory::RequestScope afterAwait;
+    std::shared_ptr<Session> sessionBefore;
+    std::shared_ptr<Session> sessionAfter;
+    int result = 0;
+    bool done = false;
+};
+
+Task handle(CppDiFactory::DiFactory& factory, CppDiFactory::RequestScope scope, bool ready,
+            std::coroutine_handle<>* resumeLater, Observed& observed)
+{
+    CppDiFactory::RequestScope::Activation activation(scope);
+    observed.beforeAwait = CppDiFactory::RequestScope::current();
+    observed.sessionBefore = factory.getInstance<Session>();
+
+    observed.result = co_await CppDiFactory::inScope(activation, Suspension{ ready, resumeLater });
+
+    observed.afterAwait = CppDiFactory::RequestScope::current();
+    observed.sessionAfter = factory.getInstance<Session>();
+    observed.done = true;
+}
+
+void registerTypes(CppDiFactory::DiFactory& factory)
+{
+    factory.registerInstanceProvidedAtRequest<Tenant>();
+    factory.registerInstancePerRequest<Session, Tenant>();
+}
+
+TEST_CASE( "CoroutineScope: the activation follows the coroutine to the resuming thread", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    CppDiFactory::RequestScope scope = myFactory.beginRequest(std::make_shared<Tenant>("request"));
+    CppDiFactory::RequestScope outer = myFactory.beginRequest(std::make_shared<Tenant>("outer"));
+    CppDiFactory::RequestScope other = myFactory.beginRequest(std::make_shared<Tenant>("other"));
+
+    Observed observed;
+    std::coroutine_handle<> resumeLater;
+    {
+        CppDiFactory::RequestScope::Activation activation(outer);
+        handle(myFactory, scope, false, &resumeLater, observed);
+
+        // suspended: the thread has its own scope again
+        CHECK(!observed.done);
+        CHECK(CppDiFactory::RequestScope::current() == outer);
+    }
+    CHECK(observed.beforeAwait == scope);
+
+    CppDiFactory::RequestScope afterOnThread;
+    std::thread thread([&]() {
+        CppDiFactory::RequestScope::Activation activation(other);
+        resumeLater.resume();
+        afterOnThread = CppDiFactory::RequestScope::current();
+    });
+    thread.join();
+
+    REQUIRE(observed.done);
+    CHECK(observed.result == 42);
+    CHECK(observed.afterAwait == scope);
+    CHECK(observed.sessionAfter == observed.sessionBefore);
+    CHECK(observed.sessionAfter->_tenant->_name == "request");
+    // the coroutine ended on the thread, which got its own scope back
+    CHECK(afterOnThread == other);
+    CHECK(!CppDiFactory::RequestScope::current());
+}
+
+TEST_CASE( "CoroutineScope: an awaiter which is ready does not change the scopes", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    CppDiFactory::RequestScope scope = myFactory.beginRequest(std::make_shared<Tenant>("request"));
+    CppDiFactory::RequestScope outer = myFactory.beginRequest(std::make_shared<Tenant>("outer"));
+
+    Observed observed;
+    std::coroutine_handle<> resumeLater;
+    {
+        CppDiFactory::RequestScope::Activation activation(outer);
+        handle(myFactory, scope, true, &resumeLater, observed);
+        CHECK(observed.done);
+        CHECK(CppDiFactory::RequestScope::current() == outer);
+    }
+    CHECK(!resumeLater);
+    CHECK(observed.afterAwait == scope);
+    CHECK(observed.sessionAfter == observed.sessionBefore);
+    CHECK(!CppDiFactory::RequestScope::current());
+}
+
+} // namespace testCaseCoroutineScope
+
+#endif // __cpp_impl_coroutine
+
+#endif // TESTCASECOROUTINESCOPE_H
@@ -0,0 +1,551 @@
+#ifndef TESTCASEDIFFERENTIAL_H
+#define TESTCASEDIFFERENTIAL_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CppDiFactory.h"
+
+/// Differential test: random registries and request sequences are run against
+/// a straightforward reference model of the resolution semantics and against
+/// the factory in each of its modes. The object graphs returned by both must
+/// have the same shape, and the same objects must be shared (within and across
+/// requests). Run more registries with CPPDIFACTORY_DIFFERENTIAL_RUNS=<n>.
+namespace testCaseDifferential
+{
+
+const int nodeCount = 10;
+const int contextType = -1;
+
+/// Objects created by the factory (serials are unique, addresses may be reused).
+class NodeBase
+{
+public:
+    NodeBase(int type, const std::vector<std::shared_ptr<NodeBase> >& dependencies):
+        type(type), serial(++serialCounter()), dependencies(dependencies) {}
+    virtual ~NodeBase() = default;
+
+    static uint64_t& serialCounter()
+    {
+        static uint64_t counter = 0;
+        return counter;
+    }
+
+    const int type;
+    const uint64_t serial;
+    const std::vector<std::shared_ptr<NodeBase> > dependencies;
+};
+
+/// Registered as InstanceProvidedAtRequest, supplied with every request.
+class Context : public NodeBase
+{
+public:
+    Context(): NodeBase(contextType, {}) {}
+};
+
+template <int I>
+class INode : public NodeBase
+{
+protected:
+    INode(const std::vector<std::shared_ptr<NodeBase> >& dependencies): NodeBase(I, dependencies) {}
+};
+
+template <int I>
+class Node : public INode<I>
+{
+public:
+    Node(): INode<I>({}) {}
+
+    template <typename... Dependencies>
+    Node(std::shared_ptr<Dependencies>... dependencies): INode<I>({ std::shared_ptr<NodeBase>(dependencies)... }) {}
+};
+
+template <typename... T>
+struct TypeList {};
+
+template <typename T>
+struct IdOf;
+
+template <int J>
+struct IdOf<INode<J> >
+{
+    static const int value = J;
+};
+
+template <>
+struct IdOf<Context>
+{
+    static const int value = contextType;
+};
+
+/// Fixed dependency graph; the registration kinds are random.
+template <int I> struct Dependencies;
+template <> struct Dependencies<0> { using type = TypeList<>; };
+template <> struct Dependencies<1> { using type = TypeList<Context>; };
+template <> struct Dependencies<2> { using type = TypeList<INode<0> >; };
+template <> struct Dependencies<3> { using type = TypeList<INode<0>, INode<2> >; };
+template <> struct Dependencies<4> { using type = TypeList<INode<1>, INode<3> >; };
+template <> struct Dependencies<5> { using type = TypeList<INode<2> >; };
+template <> struct Dependencies<6> { using type = TypeList<INode<5>, INode<3> >; };
+template <> struct Dependencies<7> { using type = TypeList<INode<4>, INode<6> >; };
+template <> struct Dependencies<8> { using type = TypeList<INode<5>, INode<2>, Context>; };
+template <> struct Dependencies<9> { using type = TypeList<INode<8>, INode<7> >; };
+
+template <typename... T>
+std::vector<int> ids(TypeList<T...>)
+{
+    return std::vector<int>{ IdOf<T>::value... };
+}
+
+enum class Kind { Class, Singleton, PerRequest, Instance };
+
+const char* kindName(Kind kind)
+{
+    switch (kind){
+    case Kind::Class:      return "Class";
+    case Kind::Singleton:  return "Singleton";
+    case Kind::PerRequest: return "PerRequest";
+    default:               return "Instance";
+    }
+}
+
+using Request = std::function<std::shared_ptr<NodeBase>(CppDiFactory::DiFactory&, const std::shared_ptr<Context>&)>;
+
+template <int I, typename... D>
+void registerNode(CppDiFactory::DiFactory& factory, Kind kind, TypeList<D...>)
+{
+    switch (kind){
+    case Kind::Class:
+        factory.registerClass<Node<I>, D...>().template withInterfaces<INode<I> >();
+        break;
+    case Kind::Singleton:
+        factory.registerSingleton<Node<I>, D...>().template withInterfaces<INode<I> >();
+        break;
+    case Kind::PerRequest:
+        factory.registerInstancePerRequest<Node<I>, D...>().template withInterfaces<INode<I> >();
+        break;
+    case Kind::Instance:
+        factory.registerInstance(std::make_shared<Node<I> >()).template withInterfaces<INode<I> >();
+        break;
+    }
+}
+
+/// Compile-time loop over all node types.
+template <int N>
+struct Nodes
+{
+    static void registerAll(CppDiFactory::DiFactory& factory, const std::vector<Kind>& kinds)
+    {
+        Nodes<N - 1>::registerAll(factory, kinds);
+        registerNode<N - 1>(factory, kinds[N - 1], typename Dependencies<N - 1>::type());
+    }
+
+    static void dependencies(std::vector<std::vector<int> >& result)
+    {
+        Nodes<N - 1>::dependencies(result);
+        result.push_back(ids(typename Dependencies<N - 1>::type()));
+    }
+
+    static void requests(std::vector<Request>& direct, std::vector<Request>& viaInterface)
+    {
+        Nodes<N - 1>::requests(direct, viaInterface);
+        direct.push_back([](CppDiFactory::DiFactory& factory, const std::shared_ptr<Context>& context) {
+            return std::shared_ptr<NodeBase>(factory.getInstance<Node<N - 1> >(context));
+        });
+        viaInterface.push_back([](CppDiFactory::DiFactory& factory, const std::shared_ptr<Context>& context) {
+            return std::shared_ptr<NodeBase>(factory.getInstance<INode<N - 1> >(context));
+        });
+    }
+
+    static void typeNames(std::vector<std::string>& result)
+    {
+        Nodes<N - 1>::typeNames(result);
+        result.push_back(CppDiFactory::typeName(typeid(Node<N - 1>)));
+        result.push_back(CppDiFactory::typeName(typeid(INode<N - 1>)));
+    }
+};
+
+template <>
+struct Nodes<0>
+{
+    static void registerAll(CppDiFactory::DiFactory&, const std::vector<Kind>&) {}
+    static void dependencies(std::vector<std::vector<int> >&) {}
+    static void requests(std::vector<Request>&, std::vector<Request>&) {}
+    static void typeNames(std::vector<std::string>&) {}
+};
+
+/// Object of the reference model.
+struct RefObject
+{
+    int type;
+    uint64_t serial;
+    std::vector<std::shared_ptr<RefObject> > dependencies;
+};
+
+/// Reference model of the resolution semantics.
+class Reference
+{
+public:
+    Reference(const std::vector<Kind>& kinds): _kinds(kinds), _singletons(kinds.size()), _instances(kinds.size()), _serial(0)
+    {
+        Nodes<nodeCount>::dependencies(_dependencies);
+        for (size_t i = 0; i < kinds.size(); ++i){
+            if (kinds[i] == Kind::Instance){
+                _instances[i] = create(static_cast<int>(i), {});
+            }
+        }
+    }
+
+    std::shared_ptr<RefObject> createContext()
+    {
+        return create(contextType, {});
+    }
+
+    /// A request fails if it reaches a singleton depending on a per-request type.
+    bool requestFails(int type) const
+    {
+        if (_kinds[type] == Kind::Instance){
+            return false;
+        }
+        if (_kinds[type] == Kind::Singleton && dependsOnPerRequest(type)){
+            return true;
+        }
+        for (int dependency : _dependencies[type]){
+            if (dependency != contextType && requestFails(dependency)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool valid() const
+    {
+        for (int type = 0; type < nodeCount; ++type){
+            if (requestFails(type)){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::shared_ptr<RefObject> request(int type, const std::shared_ptr<RefObject>& context)
+    {
+        std::unordered_map<int, std::shared_ptr<RefObject> > perRequest;
+        return resolve(type, context, perRequest);
+    }
+
+    /// Create (and retain) all singletons which do not need the context.
+    void warmUp()
+    {
+        for (int type = 0; type < nodeCount; ++type){
+            if (_kinds[type] == Kind::Singleton && !needsContext(type)){
+                std::unordered_map<int, std::shared_ptr<RefObject> > perRequest;
+                _retained.push_back(resolve(type, nullptr, perRequest));
+            }
+        }
+    }
+
+private:
+    bool dependsOnPerRequest(int type) const
+    {
+        for (int dependency : _dependencies[type]){
+            if (dependency != contextType && isPerRequest(dependency)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// The type is (or transitively depends on) a per-request type (singletons and instances stop the search).
+    bool isPerRequest(int type) const
+    {
+        switch (_kinds[type]){
+        case Kind::PerRequest: return true;
+        case Kind::Class:      return dependsOnPerRequest(type);
+        default:               return false;
+        }
+    }
+
+    bool needsContext(int type) const
+    {
+        if (_kinds[type] == Kind::Instance){
+            return false;
+        }
+        for (int dependency : _dependencies[type]){
+            if (dependency == contextType || needsContext(dependency)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::shared_ptr<RefObject> resolve(int type, const std::shared_ptr<RefObject>& context,
+                                       std::unordered_map<int, std::shared_ptr<RefObject> >& perRequest)
+    {
+        if (type == contextType){
+            return context;
+        }
+
+        switch (_kinds[type]){
+        case Kind::Instance:
+            return _instances[type];
+        case Kind::Singleton: {
+            std::shared_ptr<RefObject> instance = _singletons[type].lock();
+            if (!instance){
+                instance = create(type, resolveDependencies(type, context, perRequest));
+                _singletons[type] = instance;
+            }
+            return instance;
+        }
+        case Kind::PerRequest: {
+            std::shared_ptr<RefObject>& instance = perRequest[type];
+            if (!instance){
+                instance = create(type, resolveDependencies(type, context, perRequest));
+            }
+            return instance;
+        }
+        default:
+            return create(type, resolveDependencies(type, context, perRequest));
+        }
+    }
+
+    std::vector<std::shared_ptr<RefObject> > resolveDependencies(int type, const std::shared_ptr<RefObject>& context,
+                                                                 std::unordered_map<int, std::shared_ptr<RefObject> >& perRequest)
+    {
+        std::vector<std::shared_ptr<RefObject> > result;
+        for (int dependency : _dependencies[type]){
+            result.push_back(resolve(dependency, context, perRequest));
+        }
+        return result;
+    }
+
+    std::shared_ptr<RefObject> create(int type, const std::vector<std::shared_ptr<RefObject> >& dependencies)
+    {
+        return std::make_shared<RefObject>(RefObject{ type, ++_serial, dependencies });
+    }
+
+    const std::vector<Kind> _kinds;
+    std::vector<std::vector<int> > _dependencies;
+    std::vector<std::weak_ptr<RefObject> > _singletons;
+    std::vector<std::shared_ptr<RefObject> > _instances;
+    std::vector<std::shared_ptr<RefObject> > _retained;
+    uint64_t _serial;
+};
+
+/// One-to-one relation between the objects of the factory and of the reference model.
+class Bijection
+{
+public:
+    bool matches(const std::shared_ptr<NodeBase>& node, const std::shared_ptr<RefObject>& object)
+    {
+        if (!node || !object){
+            return !node && !object;
+        }
+        if (node->type != object->type || node->dependencies.size() != object->dependencies.size() ||
+            !pair(node->serial, object->serial)){
+            return false;
+        }
+        for (size_t i = 0; i < node->dependencies.size(); ++i){
+            if (!matches(node->dependencies[i], object->dependencies[i])){
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    bool pair(uint64_t node, uint64_t object)
+    {
+        const auto forward = _forward.find(node);
+        if (forward != _forward.end()){
+            return forward->second == object;
+        }
+        if (_backward.count(object)){
+            return false;
+        }
+        _forward[node] = object;
+        _backward[object] = node;
+        return true;
+    }
+
+    std::unordered_map<uint64_t, uint64_t> _forward;
+    std::unordered_map<uint64_t, uint64_t> _backward;
+};
+
+/// Modes of the factory which must not change the semantics.
+enum class Mode { Plain, LongLivedRegion, ValidationCache, WarmUp, Interceptor, Frozen, FrozenReplicated };
+
+const char* modeName(Mode mode)
+{
+    switch (mode){
+    case Mode::Plain:           return "Plain";
+    case Mode::LongLivedRegion: return "LongLivedRegion";
+    case Mode::ValidationCache: return "ValidationCache";
+    case Mode::WarmUp:          return "WarmUp";
+    case Mode::Frozen:          return "Frozen";
+    case Mode::FrozenReplicated: return "FrozenReplicated";
+    default:                    return "Interceptor";
+    }
+}
+
+std::unique_ptr<CppDiFactory::DiFactory> createFactory(const std::vector<Kind>& kinds, Mode mode, Reference& reference)
+{
+    std::unique_ptr<CppDiFactory::DiFactory> factory(new CppDiFactory::DiFactory());
+    factory->registerInstanceProvidedAtRequest<Context>();
+    Nodes<nodeCount>::registerAll(*factory, kinds);
+
+    switch (mode){
+    case Mode::LongLivedRegion:
+        factory->useLongLivedRegion(1 << 20);
+        break;
+    case Mode::ValidationCache: {
+        const std::string path = "differentialValidationCache.txt";
+        {
+            CppDiFactory::DiFactory first;
+            first.registerInstanceProvidedAtRequest<Context>();
+            Nodes<nodeCount>::registerAll(first, kinds);
+            first.setValidationCache(path);
+            first.validate();
+        }
+        factory->setValidationCache(path);
+        factory->validate();
+        std::remove(path.c_str());
+        break;
+    }
+    case Mode::WarmUp: {
+        const std::string path = "differentialUsageProfile.txt";
+        std::vector<std::string> types;
+        Nodes<nodeCount>::typeNames(types);
+        CppDiFactory::UsageProfile::store(path, types);
+        factory->warmUp(path);
+        reference.warmUp();
+        std::remove(path.c_str());
+        break;
+    }
+    case Mode::Interceptor:
+#if !defined(CPPDIFACTORY_NO_INTERCEPTORS)
+        factory->setInterceptor(std::make_shared<CppDiFactory::ConstructionInterceptor>());
+#endif
+        break;
+    case Mode::Frozen:
+        factory->freeze();
+        break;
+    case Mode::FrozenReplicated:
+        factory->freeze(true);
+        break;
+    default:
+        break;
+    }
+    return factory;
+}
+
+/// Run a random request sequence.
+/// \return description of the first difference (empty: no difference)
+std::string runSequence(const std::vector<Kind>& kinds, Mode mode, std::mt19937& random)
+{
+    std::vector<Request> direct;
+    std::vector<Request> viaInterface;
+    Nodes<nodeCount>::requests(direct, viaInterface);
+
+    Reference reference(kinds);
+    std::unique_ptr<CppDiFactory::DiFactory> factory = createFactory(kinds, mode, reference);
+    Bijection bijection;
+
+    // requested objects kept alive by the "application" (singletons live as long as they are used)
+    std::vector<std::pair<std::shared_ptr<NodeBase>, std::shared_ptr<RefObject> > > held(4);
+
+    for (int step = 0; step < 40; ++step){
+        const size_t slot = random() % held.size();
+        if (random() % 4 == 0){
+            held[slot] = std::make_pair(nullptr, nullptr);
+            continue;
+        }
+
+        const int type = static_cast<int>(random() % nodeCount);
+        const bool interface = random() % 2 == 0;
+        std::ostringstream request;
+        request << "step " << step << ": request " << (interface ? "INode" : "Node") << "<" << type << ">";
+
+        std::shared_ptr<Context> context = std::make_shared<Context>();
+        std::shared_ptr<NodeBase> node;
+        bool failed = false;
+        try {
+            node = (interface ? viaInterface : direct)[type](*factory, context);
+        } catch (std::logic_error* e) {
+            delete e;
+            failed = true;
+        }
+
+        if (failed != reference.requestFails(type)){
+            return request.str() + (failed ? " failed unexpectedly" : " did not fail");
+        }
+        if (failed){
+            continue;
+        }
+
+        std::shared_ptr<RefObject> object = reference.request(type, reference.createContext());
+        if (!bijection.matches(node, object)){
+            return request.str() + ": object graph or sharing differs";
+        }
+        held[slot] = std::make_pair(node, object);
+    }
+    return std::string();
+}
+
+TEST_CASE( "Differential: random registries against the reference model", "[differential]" ){
+
+    size_t runs = 150;
+    if (const char* value = std::getenv("CPPDIFACTORY_DIFFERENTIAL_RUNS")){
+        runs = static_cast<size_t>(std::strtoul(value, nullptr, 10));
+    }
+
+    const std::vector<Mode> modes{ Mode::Plain, Mode::LongLivedRegion, Mode::ValidationCache, Mode::WarmUp, Mode::Interceptor,
+                                   Mode::Frozen, Mode::FrozenReplicated };
+    size_t invalidRegistries = 0;
+
+    for (size_t run = 0; run < runs; ++run){
+        std::mt19937 random(static_cast<std::mt19937::result_type>(run));
+        std::vector<Kind> kinds;
+        std::ostringstream registry;
+        registry << "seed " << run << ":";
+        for (int i = 0; i < nodeCount; ++i){
+            kinds.push_back(static_cast<Kind>(random() % 4));
+            registry << " " << kindName(kinds.back());
+        }
+
+        const bool valid = Reference(kinds).valid();
+        if (!valid){
+            ++invalidRegistries;
+            Reference reference(kinds);
+            std::unique_ptr<CppDiFactory::DiFactory> factory = createFactory(kinds, Mode::Plain, reference);
+            INFO(registry.str());
+            CHECK_THROWS(factory->validate());
+        }
+
+        for (Mode mode : modes){
+            // modes which validate all types up front only support valid registries
+            if (!valid && mode != Mode::Plain && mode != Mode::Interceptor){
+                continue;
+            }
+            std::mt19937 sequence(static_cast<std::mt19937::result_type>(run * 7919 + 1));
+            const std::string difference = runSequence(kinds, mode, sequence);
+            INFO(registry.str() << " mode " << modeName(mode) << " " << difference);
+            CHECK(difference.empty());
+        }
+    }
+
+    // the generator must cover both valid and invalid registries
+    CHECK(invalidRegistries > 0);
+    CHECK(invalidRegistries < runs);
+}
+
+} // namespace testCaseDifferential
+
+#endif // TESTCASEDIFFERENTIAL_H
@@ -0,0 +1,75 @@
+#ifndef TESTCASEEXECUTOR_H
+#define TESTCASEEXECUTOR_H
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include "CppDiFactory.h"
+
+namespace testCaseExecutor
+{
+
+class Engine
+{
+public:
+    Engine(): _constructedOn(std::this_thread::get_id()) {}
+
+    std::thread::id _constructedOn;
+};
+
+TEST_CASE( "Executor: work stealing executor runs all tasks", "" ){
+
+    std::atomic<int> executed(0);
+    {
+        CppDiFactory::WorkStealingExecutor executor(4);
+        CHECK(executor.threadCount() == 4);
+        CHECK(!executor.runsInCurrentThread());
+
+        for (int i = 0; i < 100; ++i){
+            executor.execute([&]() {
+                // tasks scheduled by workers are queued locally (and stolen by idle workers)
+                for (int j = 0; j < 10; ++j){
+                    executor.execute([&]() { ++executed; });
+                }
+                ++executed;
+            });
+        }
+    }
+    // the destructor runs all remaining tasks
+    CHECK(executed == 1100);
+}
+
+TEST_CASE( "Executor: tasks know their executor", "" ){
+
+    CppDiFactory::WorkStealingExecutor executor(2, std::vector<int>({ 0 }));
+    std::promise<bool> inWorker;
+
+    executor.execute([&]() { inWorker.set_value(executor.runsInCurrentThread()); });
+
+    CHECK(inWorker.get_future().get());
+}
+
+TEST_CASE( "Executor: factory runs asynchronous requests on its executor", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Engine>();
+
+    auto engine = myFactory.getInstanceAsync<Engine>().get();
+    CHECK(engine->_constructedOn != std::this_thread::get_id());
+
+    // plug in an own executor
+    std::atomic<int> scheduled(0);
+    myFactory.setExecutor(std::make_shared<CppDiFactory::ExecutorAdapter>([&](std::function<void()> task) {
+        ++scheduled;
+        task();
+    }));
+
+    engine = myFactory.getInstanceAsync<Engine>().get();
+    CHECK(engine->_constructedOn == std::this_thread::get_id());
+    CHECK(scheduled == 1);
+}
+
+}
+
+#endif // TESTCASEEXECUTOR_H
@@ -0,0 +1,211 @@
+#ifndef TESTCASEFLATCOMBINING_H
+#define TESTCASEFLATCOMBINING_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "CppDiFactory.h"
+
+namespace testCaseFlatCombining
+{
+
+class Config
+{
+};
+
+class Service
+{
+public:
+    Service(std::shared_ptr<Config> config): _config(config) {}
+
+    std::shared_ptr<Config> _config;
+};
+
+class Unregistered
+{
+};
+
+template <int N>
+class Marker
+{
+};
+
+/// Counts hooks which do not run on the thread requesting their type.
+class ThreadChecker : public CppDiFactory::ConstructionInterceptor
+{
+public:
+    ThreadChecker(): mismatches(0) {}
+
+    virtual void requestBegin(const CppDiFactory::InterceptionEvent& event) override
+    {
+        check(event);
+    }
+
+    virtual void requestEnd(const CppDiFactory::InterceptionEvent& event) override
+    {
+        check(event);
+    }
+
+    void check(const CppDiFactory::InterceptionEvent& event)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (requesters[event.typeId] != std::this_thread::get_id() || event.requestId != CppDiFactory::currentRequestId()){
+            ++mismatches;
+        }
+    }
+
+    std::mutex mutex;
+    std::map<size_t, std::thread::id> requesters;
+    size_t mismatches;
+};
+
+template <int N>
+std::thread requestMarkers(CppDiFactory::DiFactory& factory, std::atomic<bool>& started)
+{
+    return std::thread([&factory, &started]() {
+        while (!started){
+            std::this_thread::yield();
+        }
+        for (int i = 0; i < 2000; ++i){
+            factory.getInstance<Marker<N> >();
+        }
+    });
+}
+
+TEST_CASE( "FlatCombining: sections of contending threads are executed exclusively", "" ){
+
+    CppDiFactory::FlatCombiningMutex<std::mutex, 4> mutex;
+    size_t counter = 0;
+    size_t locked = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t){
+        threads.push_back(std::thread([&mutex, &counter, &locked, t]() {
+            auto increment = [&counter]() { ++counter; };
+            for (int i = 0; i < 2000; ++i){
+                if (t == 0 && i % 10 == 0){
+                    std::lock_guard<CppDiFactory::FlatCombiningMutex<std::mutex, 4> > lockGuard{ mutex };
+                    ++locked;
+                } else {
+                    mutex.run(increment);
+                }
+            }
+        }));
+    }
+    for (std::thread& thread : threads){
+        thread.join();
+    }
+
+    CHECK(locked == 200);
+    CHECK(counter == 8 * 2000 - 200);
+}
+
+TEST_CASE( "FlatCombining: exceptions are rethrown on the publishing thread", "" ){
+
+    CppDiFactory::FlatCombiningMutex<std::mutex> mutex;
+    size_t thrown = 0;
+    size_t run = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t){
+        threads.push_back(std::thread([&mutex, &thrown, &run, t]() {
+            auto failing = []() { throw std::runtime_error("failed"); };
+            auto counting = [&run]() { ++run; };
+            for (int i = 0; i < 500; ++i){
+                if (t % 2 == 0){
+                    try {
+                        mutex.run(failing);
+                    } catch (const std::runtime_error&) {
+                        std::lock_guard<CppDiFactory::FlatCombiningMutex<std::mutex> > lockGuard{ mutex };
+                        ++thrown;
+                    }
+                } else {
+                    mutex.run(counting);
+                }
+            }
+        }));
+    }
+    for (std::thread& thread : threads){
+        thread.join();
+    }
+
+    CHECK(thrown == 2 * 500);
+    CHECK(run == 2 * 500);
+}
+
+TEST_CASE( "FlatCombining: concurrent requests and registrations", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerSingleton<Config>();
+    myFactory.registerClass<Service, Config>();
+    std::shared_ptr<Config> config = myFactory.getInstance<Config>();
+
+    CHECK_THROWS(myFactory.getInstance<Unregistered>());
+
+#ifdef MULTITHREADED
+    std::vector<bool> sameConfig(8, true);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < sameConfig.size(); ++t){
+        threads.push_back(std::thread([&myFactory, &sameConfig, config, t]() {
+            for (int i = 0; i < 500; ++i){
+                if (t == 0 && i % 50 == 0){
+                    myFactory.registerClass<Unregistered>();
+                }
+                bool same = myFactory.getInstance<Service>()->_config == config;
+                sameConfig[t] = sameConfig[t] && same;
+            }
+        }));
+    }
+    for (std::thread& thread : threads){
+        thread.join();
+    }
+
+    bool allSame = true;
+    for (bool same : sameConfig){
+        allSame = allSame && same;
+    }
+    CHECK(allSame);
+    CHECK(myFactory.getInstance<Unregistered>());
+#endif
+}
+
+#if defined(MULTITHREADED) && !defined(CPPDIFACTORY_NO_INTERCEPTORS)
+TEST_CASE( "FlatCombining: requests with interceptors run on their own thread", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Marker<0> >();
+    myFactory.registerClass<Marker<1> >();
+    myFactory.registerClass<Marker<2> >();
+    myFactory.registerClass<Marker<3> >();
+    auto checker = std::make_shared<ThreadChecker>();
+    myFactory.setInterceptor(checker);
+
+    std::atomic<bool> started(false);
+    std::vector<std::thread> threads;
+    threads.push_back(requestMarkers<0>(myFactory, started));
+    threads.push_back(requestMarkers<1>(myFactory, started));
+    threads.push_back(requestMarkers<2>(myFactory, started));
+    threads.push_back(requestMarkers<3>(myFactory, started));
+    {
+        std::lock_guard<std::mutex> lock(checker->mutex);
+        checker->requesters[CppDiFactory::type_id<Marker<0> >()] = threads[0].get_id();
+        checker->requesters[CppDiFactory::type_id<Marker<1> >()] = threads[1].get_id();
+        checker->requesters[CppDiFactory::type_id<Marker<2> >()] = threads[2].get_id();
+        checker->requesters[CppDiFactory::type_id<Marker<3> >()] = threads[3].get_id();
+    }
+    started = true;
+    for (std::thread& thread : threads){
+        thread.join();
+    }
+
+    CHECK(checker->mismatches == 0);
+}
+#endif
+
+} // namespace testCaseFlatCombining
+
+#endif // TESTCASEFLATCOMBINING_H
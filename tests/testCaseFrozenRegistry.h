@@ -0,0 +1,126 @@
+#ifndef TESTCASEFROZENREGISTRY_H
+#define TESTCASEFROZENREGISTRY_H
+
+#include <utility>
+#include <vector>
+
+#include "CppDiFactory.h"
+
+namespace testCaseFrozenRegistry
+{
+
+class Config
+{
+};
+
+class IService
+{
+public:
+    virtual ~IService() = default;
+};
+
+class Service : public IService
+{
+public:
+    Service(std::shared_ptr<Config> config): _config(config) {}
+
+    std::shared_ptr<Config> _config;
+};
+
+class Unregistered
+{
+};
+
+void registerTypes(CppDiFactory::DiFactory& factory)
+{
+    factory.registerSingleton<Config>();
+    factory.registerClass<Service, Config>().withInterfaces<IService>();
+}
+
+TEST_CASE( "FrozenRegistry: lookup table finds all entries", "" ){
+
+    std::vector<int> values(1000);
+    std::vector<std::pair<size_t, int*> > entries;
+    for (size_t i = 0; i < values.size(); ++i){
+        // keys with the same low bits, like the addresses used as type ids
+        entries.push_back(std::make_pair((i + 1) * 64, &values[i]));
+    }
+    CppDiFactory::FrozenLookupTable<int> table(entries);
+    CHECK(table.capacity() >= 2 * entries.size());
+
+    bool allFound = true;
+    for (const auto& entry : entries){
+        allFound = allFound && table.find(entry.first) == entry.second;
+    }
+    CHECK(allFound);
+    CHECK(!table.find(32));
+    CHECK(!table.find(64 * 2000));
+
+    CppDiFactory::FrozenLookupTable<int> empty((std::vector<std::pair<size_t, int*> >()));
+    CHECK(!empty.find(64));
+}
+
+TEST_CASE( "FrozenRegistry: a frozen factory resolves as before", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    CHECK(!myFactory.isFrozen());
+
+    myFactory.freeze();
+    CHECK(myFactory.isFrozen());
+
+    std::shared_ptr<IService> service = myFactory.getInstance<IService>();
+    REQUIRE(service);
+    CHECK(service != myFactory.getInstance<IService>());
+    CHECK(std::static_pointer_cast<Service>(service)->_config == myFactory.getInstance<Config>());
+    CHECK_THROWS(myFactory.getInstance<Unregistered>());
+}
+
+TEST_CASE( "FrozenRegistry: registrations cannot be changed once frozen", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    myFactory.freeze();
+
+    CHECK_THROWS(myFactory.registerClass<Unregistered>());
+    CHECK_THROWS(myFactory.registerSingleton<Config>());
+    CHECK_THROWS(myFactory.unregister<Config>());
+    CHECK(myFactory.getInstance<Config>());
+}
+
+TEST_CASE( "FrozenRegistry: freezing validates all registrations", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Service, Config>();
+    CHECK_THROWS(myFactory.freeze());
+    CHECK(!myFactory.isFrozen());
+}
+
+TEST_CASE( "FrozenRegistry: one lookup table per NUMA node", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    myFactory.freeze(true);
+
+    std::vector<std::pair<size_t, int*> > entries;
+    CppDiFactory::FrozenRegistry<int> registry;
+    registry.build(entries, true);
+    CHECK(registry.replicas() == CppDiFactory::NumaTopology::instance().nodeCount());
+    registry.build(entries, false);
+    CHECK(registry.replicas() == 1);
+
+    // shared singletons, whichever node the request runs on
+    std::shared_ptr<Config> config = myFactory.getInstance<Config>();
+    const CppDiFactory::NumaTopology& topology = CppDiFactory::NumaTopology::instance();
+    for (size_t node = 0; node < topology.nodeCount(); ++node){
+        std::shared_ptr<Config> onNode;
+        topology.runOnNode(node, [&]() {
+            onNode = myFactory.getInstance<Config>();
+        });
+        CHECK(onNode == config);
+    }
+}
+
+} // namespace testCaseFrozenRegistry
+
+#endif // TESTCASEFROZENREGISTRY_H
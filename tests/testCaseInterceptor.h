@@ -0,0 +1,118 @@
+#ifndef TESTCASEINTERCEPTOR_H
+#define TESTCASEINTERCEPTOR_H
+
+#include <string>
+#include <vector>
+
+#include "CppDiFactory.h"
+
+#if !defined(CPPDIFACTORY_NO_INTERCEPTORS)
+
+namespace testCaseInterceptor
+{
+
+using CppDiFactory::InterceptionEvent;
+
+class Config
+{
+};
+
+class IService
+{
+public:
+    virtual ~IService() = default;
+};
+
+class Service : public IService
+{
+public:
+    Service(std::shared_ptr<Config>) {}
+};
+
+class Recorder : public CppDiFactory::ConstructionInterceptor
+{
+public:
+    virtual void requestBegin(const InterceptionEvent& event) override { add("begin", event); }
+    virtual void requestEnd(const InterceptionEvent& event) override { add("end", event); }
+    virtual void beforeConstruction(const InterceptionEvent& event) override { add("before", event); }
+    virtual void afterConstruction(const InterceptionEvent& event) override { add("after", event); }
+    virtual void singletonCreated(const InterceptionEvent& event) override { add("created", event); }
+    virtual void singletonExpired(const InterceptionEvent& event) override { add("expired", event); }
+
+    void add(const std::string& hook, const InterceptionEvent& event)
+    {
+        hooks.push_back(hook + " " + event.typeName());
+        events.push_back(event);
+    }
+
+    std::vector<std::string> hooks;
+    std::vector<InterceptionEvent> events;
+};
+
+TEST_CASE( "Interceptor: hooks of a request", "" ){
+
+    using CppDiFactory::RegistrationKind;
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerSingleton<Config>();
+    myFactory.registerClass<Service, Config>().withInterfaces<IService>();
+
+    auto recorder = std::make_shared<Recorder>();
+    myFactory.setInterceptor(recorder);
+
+    auto service = myFactory.getInstance<IService>();
+
+    const std::vector<std::string> expected{
+        "begin testCaseInterceptor::IService",
+        "before testCaseInterceptor::Config",
+        "after testCaseInterceptor::Config",
+        "created testCaseInterceptor::Config",
+        "before testCaseInterceptor::Service",
+        "after testCaseInterceptor::Service",
+        "end testCaseInterceptor::IService"
+    };
+    CHECK(recorder->hooks == expected);
+
+    REQUIRE(recorder->events.size() == expected.size());
+    CHECK(recorder->events[0].kind == RegistrationKind::Interface);
+    CHECK(recorder->events[1].kind == RegistrationKind::Singleton);
+    CHECK(recorder->events[4].kind == RegistrationKind::Class);
+    CHECK(recorder->events[5].instance == service.get());
+    CHECK(recorder->events[6].instance == service.get());
+    CHECK(recorder->events[6].typeId == CppDiFactory::type_id<IService>());
+    CHECK(recorder->events[6].timestamp >= recorder->events[0].timestamp);
+
+    const uint64_t requestId = recorder->events[0].requestId;
+    CHECK(requestId != 0);
+    for (const InterceptionEvent& event : recorder->events){
+        CHECK(event.requestId == requestId);
+    }
+
+    // the next request gets a new id, the expired singleton is reported
+    service.reset();
+    recorder->hooks.clear();
+    recorder->events.clear();
+    myFactory.getInstance<Service>();
+    REQUIRE(recorder->events.size() > 2);
+    CHECK(recorder->events[0].requestId > requestId);
+    CHECK(recorder->hooks[1] == "expired testCaseInterceptor::Config");
+}
+
+TEST_CASE( "Interceptor: removed interceptor", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Config>();
+
+    auto recorder = std::make_shared<Recorder>();
+    myFactory.setInterceptor(recorder);
+    myFactory.setInterceptor(nullptr);
+    myFactory.getInstance<Config>();
+
+    CHECK(recorder->hooks.empty());
+}
+
+} // namespace testCaseInterceptor
+
+#endif // CPPDIFACTORY_NO_INTERCEPTORS
+
+#endif // TESTCASEINTERCEPTOR_H
@@ -0,0 +1,291 @@
+#ifndef TESTCASELIFETIMEADVISOR_H
+#define TESTCASELIFETIMEADVISOR_H
+
+#include <chrono>
+#include <vector>
+
+#include "CppDiFactory.h"
+
+namespace testCaseLifetimeAdvisor
+{
+
+class Config
+{
+};
+
+class Formatter
+{
+public:
+    Formatter(std::shared_ptr<Config> config): _config(config) {}
+
+    std::shared_ptr<Config> _config;
+};
+
+class Buffer
+{
+};
+
+class Index
+{
+public:
+    Index()
+    {
+        const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+        while (std::chrono::steady_clock::now() < end){
+            // expensive construction
+        }
+    }
+};
+
+class Search
+{
+public:
+    Search(std::shared_ptr<Index> index): _index(index) {}
+
+    std::shared_ptr<Index> _index;
+};
+
+class Cache
+{
+};
+
+class Context
+{
+};
+
+class Transaction
+{
+};
+
+class Repository
+{
+public:
+    Repository(std::shared_ptr<Transaction> transaction): _transaction(transaction) {}
+
+    std::shared_ptr<Transaction> _transaction;
+};
+
+class Service
+{
+public:
+    Service(std::shared_ptr<Repository> repository, std::shared_ptr<Transaction> transaction):
+        _repository(repository), _transaction(transaction) {}
+
+    std::shared_ptr<Repository> _repository;
+    std::shared_ptr<Transaction> _transaction;
+};
+
+void registerTypes(CppDiFactory::DiFactory& factory)
+{
+    factory.registerSingleton<Config>();
+    factory.registerClass<Formatter, Config>();
+    factory.registerClass<Buffer>();
+    factory.registerClass<Index>();
+    factory.registerClass<Search, Index>();
+    factory.registerSingleton<Cache>();
+    factory.registerInstancePerRequest<Context>();
+    factory.registerInstancePerRequest<Transaction>();
+    factory.registerClass<Repository, Transaction>();
+    factory.registerClass<Service, Repository, Transaction>();
+}
+
+const CppDiFactory::LifetimeAdvice* findAdvice(const CppDiFactory::LifetimeReport& report, const std::string& type)
+{
+    for (const CppDiFactory::LifetimeAdvice& advice : report.advice){
+        if (advice.type.find(type) != std::string::npos && advice.change != CppDiFactory::LifetimeAdvice::Change::Lazy){
+            return &advice;
+        }
+    }
+    return nullptr;
+}
+
+const CppDiFactory::LifetimeAdvice* findLazy(const CppDiFactory::LifetimeReport& report, const std::string& type)
+{
+    for (const CppDiFactory::LifetimeAdvice& advice : report.advice){
+        if (advice.type.find(type) != std::string::npos && advice.change == CppDiFactory::LifetimeAdvice::Change::Lazy){
+            return &advice;
+        }
+    }
+    return nullptr;
+}
+
+TEST_CASE( "LifetimeAdvisor: recommends lifetime changes from observed instances", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    myFactory.getInstance<Formatter>();
+    CHECK(myFactory.adviseLifetimes().advice.empty());
+
+    myFactory.enableLifetimeAdvisor();
+    std::shared_ptr<Config> config = myFactory.getInstance<Config>();
+    for (int i = 0; i < 12; ++i){
+        myFactory.getInstance<Formatter>();
+        myFactory.getInstance<Cache>();
+        myFactory.getInstance<Context>();
+        myFactory.getInstance<Service>();
+    }
+    for (int i = 0; i < 4; ++i){
+        std::vector<std::shared_ptr<Buffer> > buffers;
+        for (int j = 0; j < 3; ++j){
+            buffers.push_back(myFactory.getInstance<Buffer>());
+        }
+    }
+    for (int i = 0; i < 10; ++i){
+        myFactory.getInstance<Search>();
+    }
+    myFactory.enableLifetimeAdvisor(false);
+
+    // independent of the scheduling: all instances are short-lived and only
+    // the busy Index construction takes long enough to be a Lazy candidate
+    CppDiFactory::LifetimeAdvisorOptions options;
+    options.shortLived = std::chrono::hours(1);
+    options.lazyMinTime = std::chrono::milliseconds(1);
+    const CppDiFactory::LifetimeReport report = myFactory.adviseLifetimes(options);
+
+    const CppDiFactory::LifetimeAdvice* formatter = findAdvice(report, "Formatter");
+    REQUIRE(formatter);
+    CHECK(formatter->change == CppDiFactory::LifetimeAdvice::Change::Singleton);
+    CHECK(formatter->observed == 12);
+    CHECK(formatter->savedConstructions == 11);
+
+    const CppDiFactory::LifetimeAdvice* buffer = findAdvice(report, "Buffer");
+    REQUIRE(buffer);
+    CHECK(buffer->change == CppDiFactory::LifetimeAdvice::Change::Pool);
+    CHECK(buffer->poolSize == 3);
+    CHECK(buffer->savedAllocations == 9);
+
+    const CppDiFactory::LifetimeAdvice* cache = findAdvice(report, "Cache");
+    REQUIRE(cache);
+    CHECK(cache->change == CppDiFactory::LifetimeAdvice::Change::Retain);
+    CHECK(cache->savedConstructions == 11);
+
+    const CppDiFactory::LifetimeAdvice* context = findAdvice(report, "Context");
+    REQUIRE(context);
+    CHECK(context->change == CppDiFactory::LifetimeAdvice::Change::Transient);
+    CHECK(context->savedAllocations == 12);
+
+    const CppDiFactory::LifetimeAdvice* lazyIndex = findLazy(report, "Index");
+    REQUIRE(lazyIndex);
+    CHECK(lazyIndex->consumer.find("Search") != std::string::npos);
+    CHECK(lazyIndex->savedConstructions == 10);
+
+    const CppDiFactory::LifetimeAdvice* index = findAdvice(report, "Index");
+    REQUIRE(index);
+    CHECK(index->change == CppDiFactory::LifetimeAdvice::Change::Singleton);
+
+    // shared within each request, built from different instances or too few observations
+    CHECK(!findAdvice(report, "Transaction"));
+    CHECK(!findAdvice(report, "Repository"));
+    CHECK(!findAdvice(report, "Service"));
+    CHECK(!findAdvice(report, "Config"));
+
+    // Formatter, Buffer, Cache, Context and Index (without the Lazy one)
+    CHECK(report.savedConstructions == 11 + 9 + 11 + 0 + 9);
+    CHECK(report.savedAllocations == 11 + 9 + 11 + 12 + 9);
+    for (size_t i = 1; i < report.advice.size(); ++i){
+        const size_t previous = report.advice[i - 1].savedConstructions + report.advice[i - 1].savedAllocations;
+        const size_t current = report.advice[i].savedConstructions + report.advice[i].savedAllocations;
+        CHECK(previous >= current);
+    }
+
+    myFactory.resetLifetimeObservations();
+    CHECK(myFactory.adviseLifetimes().advice.empty());
+}
+
+CppDiFactory::LifetimeSubject subject(size_t typeId, const std::string& type, CppDiFactory::RegistrationKind kind,
+                                      std::vector<size_t> dependencies = std::vector<size_t>())
+{
+    CppDiFactory::LifetimeSubject result{ typeId, type, kind, dependencies, CppDiFactory::LifetimeObservation() };
+    return result;
+}
+
+TEST_CASE( "LifetimeAdvisor: recommendations from synthetic observations", "" ){
+
+    CppDiFactory::LifetimeAdvisorOptions options;
+    std::vector<CppDiFactory::LifetimeSubject> subjects;
+
+    // short-lived, one alive at a time
+    subjects.push_back(subject(1, "Formatter", CppDiFactory::RegistrationKind::Class));
+    subjects.back().observation.constructions = 12;
+    subjects.back().observation.tracked = 12;
+    subjects.back().observation.destroyed = 12;
+    subjects.back().observation.maxAlive = 1;
+    subjects.back().observation.maxLifetime = std::chrono::milliseconds(1);
+
+    // like Formatter, but living too long
+    subjects.push_back(subject(2, "Session", CppDiFactory::RegistrationKind::Class));
+    subjects.back().observation = subjects.front().observation;
+    subjects.back().observation.maxLifetime = std::chrono::seconds(1);
+
+    // expensive dependency of a cheap consumer
+    subjects.push_back(subject(3, "Index", CppDiFactory::RegistrationKind::Class));
+    subjects.back().observation.constructions = 10;
+    subjects.back().observation.constructionTime = std::chrono::milliseconds(20);
+    subjects.back().observation.identicalDependencies = false;
+    subjects.push_back(subject(4, "Search", CppDiFactory::RegistrationKind::Class, std::vector<size_t>{ 3 }));
+    subjects.back().observation.constructions = 10;
+    subjects.back().observation.constructionTime = std::chrono::microseconds(10);
+    subjects.back().observation.identicalDependencies = false;
+
+    subjects.push_back(subject(5, "Cache", CppDiFactory::RegistrationKind::Singleton));
+    subjects.back().observation.expiries = 3;
+
+    subjects.push_back(subject(6, "Context", CppDiFactory::RegistrationKind::SingleInstancePerRequest));
+    subjects.back().observation.requestCreations = 10;
+
+    const CppDiFactory::LifetimeReport report = CppDiFactory::adviseLifetimes(subjects, options);
+
+    const CppDiFactory::LifetimeAdvice* formatter = findAdvice(report, "Formatter");
+    REQUIRE(formatter);
+    CHECK(formatter->change == CppDiFactory::LifetimeAdvice::Change::Singleton);
+    CHECK(formatter->savedConstructions == 11);
+    CHECK(!findAdvice(report, "Session"));
+
+    const CppDiFactory::LifetimeAdvice* index = findLazy(report, "Index");
+    REQUIRE(index);
+    CHECK(index->consumer == "Search");
+    CHECK(!findAdvice(report, "Index"));
+    CHECK(!findAdvice(report, "Search"));
+
+    const CppDiFactory::LifetimeAdvice* cache = findAdvice(report, "Cache");
+    REQUIRE(cache);
+    CHECK(cache->change == CppDiFactory::LifetimeAdvice::Change::Retain);
+
+    const CppDiFactory::LifetimeAdvice* context = findAdvice(report, "Context");
+    REQUIRE(context);
+    CHECK(context->change == CppDiFactory::LifetimeAdvice::Change::Transient);
+
+    CHECK(report.advice.size() == 4);
+    CHECK(report.constructions == 12 + 12 + 10 + 10);
+    CHECK(report.savedConstructions == 11 + 3);
+    CHECK(report.savedAllocations == 11 + 3 + 10);
+}
+
+TEST_CASE( "LifetimeAdvisor: types without observations", "" ){
+
+    CppDiFactory::LifetimeAdvisorOptions options;
+    options.minObservations = 0;
+    options.minExpiries = 0;
+    options.lazyMinTime = std::chrono::nanoseconds(0);
+
+    std::vector<CppDiFactory::LifetimeSubject> subjects;
+    subjects.push_back(subject(1, "Index", CppDiFactory::RegistrationKind::Class));
+    subjects.push_back(subject(2, "Search", CppDiFactory::RegistrationKind::Class, std::vector<size_t>{ 1 }));
+    subjects.push_back(subject(3, "Cache", CppDiFactory::RegistrationKind::Singleton));
+    subjects.push_back(subject(4, "Context", CppDiFactory::RegistrationKind::SingleInstancePerRequest));
+
+    const CppDiFactory::LifetimeReport report = CppDiFactory::adviseLifetimes(subjects, options);
+    CHECK(report.advice.empty());
+    CHECK(report.savedConstructions == 0);
+
+    // observed, but without construction times
+    subjects[0].observation.constructions = 5;
+    subjects[1].observation.constructions = 5;
+    subjects[0].observation.identicalDependencies = false;
+    subjects[1].observation.identicalDependencies = false;
+    CHECK(CppDiFactory::adviseLifetimes(subjects, options).advice.empty());
+}
+
+} // namespace testCaseLifetimeAdvisor
+
+#endif // TESTCASELIFETIMEADVISOR_H
@@ -0,0 +1,140 @@
+#ifndef TESTCASELIFETIMEGROUP_H
+#define TESTCASELIFETIMEGROUP_H
+
+#include <atomic>
+
+#include "CppDiFactory.h"
+
+namespace testCaseLifetimeGroup
+{
+
+std::atomic<int> constructed(0);
+std::atomic<int> alive(0);
+
+class Counted
+{
+public:
+    Counted() { ++constructed; ++alive; }
+    virtual ~Counted() { --alive; }
+};
+
+class Database : public Counted
+{
+};
+
+class Cache : public Counted
+{
+};
+
+class Metrics : public Counted
+{
+};
+
+class Repository : public Counted
+{
+public:
+    Repository(std::shared_ptr<Database> database, std::shared_ptr<Cache> cache): _database(database), _cache(cache) {}
+
+    std::shared_ptr<Database> _database;
+    std::shared_ptr<Cache> _cache;
+};
+
+class Service
+{
+public:
+    Service(std::shared_ptr<Repository> repository): _repository(repository) {}
+
+    std::shared_ptr<Repository> _repository;
+};
+
+void registerTypes(CppDiFactory::DiFactory& factory)
+{
+    factory.registerSingleton<Database>();
+    factory.registerSingleton<Cache>();
+    factory.registerSingleton<Metrics>();
+    factory.registerSingleton<Repository, Database, Cache>();
+    factory.registerClass<Service, Repository>();
+}
+
+TEST_CASE( "LifetimeGroup: members are constructed and released together", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    myFactory.registerLifetimeGroup<Database, Cache, Metrics, Repository>();
+
+    constructed = 0;
+    alive = 0;
+    std::shared_ptr<Service> service = myFactory.getInstance<Service>();
+    CHECK(constructed == 4);
+    CHECK(service->_repository->_database.get() == myFactory.getInstance<Database>().get());
+    CHECK(constructed == 4);
+
+    // any member keeps the whole group alive
+    std::shared_ptr<Metrics> metrics = myFactory.getInstance<Metrics>();
+    Repository* repository = service->_repository.get();
+    service.reset();
+    CHECK(alive == 4);
+    CHECK(myFactory.getInstance<Service>()->_repository.get() == repository);
+    CHECK(constructed == 4);
+
+    metrics.reset();
+    CHECK(alive == 0);
+
+    myFactory.getInstance<Cache>();
+    CHECK(constructed == 8);
+    CHECK(alive == 0);
+}
+
+TEST_CASE( "LifetimeGroup: members of a level are constructed on the executor", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    myFactory.registerLifetimeGroup<Database, Cache, Repository>(std::make_shared<CppDiFactory::WorkStealingExecutor>(2));
+
+    constructed = 0;
+    std::shared_ptr<Repository> repository = myFactory.getInstance<Repository>();
+    CHECK(constructed == 3);
+    CHECK(repository->_cache == myFactory.getInstance<Cache>());
+
+    // not a member, keeps its own lifetime
+    std::shared_ptr<Metrics> metrics = myFactory.getInstance<Metrics>();
+    CHECK(constructed == 4);
+    metrics.reset();
+    repository.reset();
+    CHECK(alive == 0);
+}
+
+TEST_CASE( "LifetimeGroup: retaining a member retains the group", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    myFactory.registerSingleton<Metrics>().retain();
+    myFactory.registerLifetimeGroup<Metrics, Database>();
+
+    constructed = 0;
+    Database* database = myFactory.getInstance<Database>().get();
+    CHECK(alive == 2);
+    CHECK(myFactory.getInstance<Database>().get() == database);
+    CHECK(constructed == 2);
+}
+
+TEST_CASE( "LifetimeGroup: only singletons can be members of one group", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    myFactory.registerLifetimeGroup<Database, Repository>();
+    CHECK_THROWS((myFactory.registerLifetimeGroup<Cache, Database>()));
+
+    // rejected at registration, nothing of the group is registered
+    CHECK_THROWS((myFactory.registerLifetimeGroup<Cache, Service>()));
+    myFactory.registerLifetimeGroup<Cache>();
+    CHECK_THROWS(myFactory.registerClass<Database>());
+    CHECK_NOTHROW(myFactory.registerSingleton<Database>());
+
+    myFactory.freeze();
+    CHECK_THROWS(myFactory.registerLifetimeGroup<Metrics>());
+}
+
+} // namespace testCaseLifetimeGroup
+
+#endif // TESTCASELIFETIMEGROUP_H
@@ -0,0 +1,101 @@
+#ifndef TESTCASELONGLIVEDREGION_H
+#define TESTCASELONGLIVEDREGION_H
+
+#include "CppDiFactory.h"
+
+namespace testCaseLongLivedRegion
+{
+
+class IScrew
+{
+public:
+    virtual bool tight() const = 0;
+    virtual ~IScrew() = default;
+};
+
+class IEngine
+{
+public:
+    virtual double getVolume() const = 0;
+    virtual ~IEngine() = default;
+};
+
+class Screw : public IScrew
+{
+public:
+    virtual bool tight() const override
+    {
+        return true;
+    }
+};
+
+class Engine : public IEngine
+{
+public:
+    Engine(std::shared_ptr<IScrew> screw):
+        _screw(screw)
+    {}
+
+    virtual double getVolume() const override
+    {
+        return 10.5;
+    }
+
+private:
+    std::shared_ptr<IScrew> _screw;
+};
+
+TEST_CASE( "LongLivedRegion: singletons are allocated from the region", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.useLongLivedRegion(64 * 1024);
+
+    myFactory.registerSingleton<Engine, IScrew>().withInterfaces<IEngine>();
+    myFactory.registerClass<Screw>().withInterfaces<IScrew>();
+
+    auto engine = myFactory.getInstance<IEngine>();
+    auto screw  = myFactory.getInstance<IScrew>();
+
+    CHECK(myFactory.longLivedRegion()->contains(engine.get()));
+    CHECK(!myFactory.longLivedRegion()->contains(screw.get()));
+}
+
+TEST_CASE( "LongLivedRegion: exhausted region falls back to heap", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.useLongLivedRegion(1);
+
+    myFactory.registerSingleton<Screw>().withInterfaces<IScrew>();
+
+    auto screw = myFactory.getInstance<IScrew>();
+
+    CHECK(screw->tight());
+    CHECK(!myFactory.longLivedRegion()->contains(screw.get()));
+}
+
+TEST_CASE( "LongLivedRegion: region is rewound once all instances are released", "" ){
+
+    std::shared_ptr<const CppDiFactory::LongLivedRegion> region;
+    std::shared_ptr<IScrew> screw;
+
+    {
+        CppDiFactory::DiFactory myFactory;
+        myFactory.useLongLivedRegion(64 * 1024, CppDiFactory::HugePages::Transparent);
+        region = myFactory.longLivedRegion();
+
+        myFactory.registerSingleton<Screw>().withInterfaces<IScrew>();
+
+        screw = myFactory.getInstance<IScrew>();
+        CHECK(region->contains(screw.get()));
+    }
+
+    // the instance keeps the region alive after the factory is gone
+    CHECK(region->used() > 0);
+
+    screw.reset();
+    CHECK(region->used() == 0);
+}
+
+}
+
+#endif // TESTCASELONGLIVEDREGION_H
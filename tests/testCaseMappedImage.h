@@ -0,0 +1,129 @@
+#ifndef TESTCASEMAPPEDIMAGE_H
+#define TESTCASEMAPPEDIMAGE_H
+
+#include <cstdio>
+#include <cstring>
+
+#include "CppDiFactory.h"
+
+namespace testCaseMappedImage
+{
+
+class Table
+{
+public:
+    Table()
+    {
+        ++constructions;
+        for (int i = 0; i < size; ++i){
+            _values[i] = i * i;
+        }
+    }
+
+    int value(int i) const
+    {
+        return _values[i];
+    }
+
+    static const int size = 4096;
+    static int constructions;
+
+private:
+    int _values[size];
+};
+
+int Table::constructions = 0;
+
+}
+
+namespace CppDiFactory
+{
+template <> struct MappableImage<testCaseMappedImage::Table> : std::true_type {};
+}
+
+namespace testCaseMappedImage
+{
+
+TEST_CASE( "MappedImage: second factory maps the image instead of constructing", "" ){
+
+    const std::string path = "cppdifactory_test_table.image";
+    std::remove(path.c_str());
+    Table::constructions = 0;
+
+    {
+        CppDiFactory::DiFactory myFactory;
+        myFactory.registerMappedImage<Table>(path, 1);
+
+        auto table1 = myFactory.getInstance<Table>();
+        auto table2 = myFactory.getInstance<Table>();
+        CHECK(table1 == table2);
+        CHECK(Table::constructions == 1);
+    }
+
+    {
+        CppDiFactory::DiFactory myFactory;
+        myFactory.registerMappedImage<Table>(path, 1);
+
+        auto table = myFactory.getInstance<Table>();
+        CHECK(Table::constructions == 1);
+        CHECK(table->value(Table::size - 1) == (Table::size - 1) * (Table::size - 1));
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE( "MappedImage: invalid image is rebuilt", "" ){
+
+    const std::string path = "cppdifactory_test_invalid.image";
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    std::fputs("not an image", file);
+    std::fclose(file);
+    Table::constructions = 0;
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerMappedImage<Table>(path, 1);
+
+    auto table = myFactory.getInstance<Table>();
+    CHECK(Table::constructions == 1);
+    CHECK(table->value(3) == 9);
+
+    CHECK(CppDiFactory::MappedImage::map<Table>(path, 1) != nullptr);
+    std::remove(path.c_str());
+}
+
+TEST_CASE( "MappedImage: image of another version is rebuilt", "" ){
+
+    const std::string path = "cppdifactory_test_version.image";
+    std::remove(path.c_str());
+    CHECK(CppDiFactory::MappedImage::write(path, Table(), 1));
+    Table::constructions = 0;
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerMappedImage<Table>(path, 2);
+
+    myFactory.getInstance<Table>();
+    CHECK(Table::constructions == 1);
+    CHECK(CppDiFactory::MappedImage::map<Table>(path, 1) == nullptr);
+    CHECK(CppDiFactory::MappedImage::map<Table>(path, 2) != nullptr);
+    std::remove(path.c_str());
+}
+
+TEST_CASE( "MappedImage: modifications stay in the process", "" ){
+
+    const std::string path = "cppdifactory_test_private.image";
+    std::remove(path.c_str());
+    CHECK(CppDiFactory::MappedImage::write(path, Table(), 1));
+
+    auto mapped = CppDiFactory::MappedImage::map<Table>(path, 1);
+    REQUIRE(mapped != nullptr);
+    CHECK(mapped->value(3) == 9);
+
+    std::memset(static_cast<void*>(mapped.get()), 0, sizeof(Table));
+    CHECK(mapped->value(3) == 0);
+    CHECK(CppDiFactory::MappedImage::map<Table>(path, 1)->value(3) == 9);
+    std::remove(path.c_str());
+}
+
+}
+
+#endif // TESTCASEMAPPEDIMAGE_H
@@ -0,0 +1,104 @@
+#ifndef TESTCASEMEMORYPRESSURE_H
+#define TESTCASEMEMORYPRESSURE_H
+
+#include "CppDiFactory.h"
+
+namespace testCaseMemoryPressure
+{
+
+class ICache
+{
+public:
+    virtual ~ICache() = default;
+};
+
+class Cache : public ICache
+{
+};
+
+class Index
+{
+};
+
+TEST_CASE( "MemoryPressure: retained singleton is kept until memory pressure", "" ){
+
+    using CppDiFactory::MemoryPressure;
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerSingleton<Cache>().retain().withInterfaces<ICache>();
+
+    std::weak_ptr<ICache> first = myFactory.getInstance<ICache>();
+    CHECK(!first.expired());
+
+    myFactory.onMemoryPressure(MemoryPressure::Low);
+    CHECK(!first.expired());
+
+    myFactory.onMemoryPressure(MemoryPressure::Moderate);
+    CHECK(first.expired());
+
+    // a new instance is created (and retained) with the next request
+    std::weak_ptr<ICache> second = myFactory.getInstance<ICache>();
+    CHECK(!second.expired());
+}
+
+TEST_CASE( "MemoryPressure: eviction level", "" ){
+
+    using CppDiFactory::MemoryPressure;
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerSingleton<Cache>().retain().evictAt(MemoryPressure::Critical);
+    myFactory.registerSingleton<Index>().retain();
+
+    std::weak_ptr<Cache> cache = myFactory.getInstance<Cache>();
+    std::weak_ptr<Index> index = myFactory.getInstance<Index>();
+
+    myFactory.onMemoryPressure(MemoryPressure::Moderate);
+    CHECK(!cache.expired());
+    CHECK(index.expired());
+
+    myFactory.onMemoryPressure(MemoryPressure::Critical);
+    CHECK(cache.expired());
+}
+
+TEST_CASE( "MemoryPressure: instances in use are not destroyed", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerSingleton<Cache>().retain();
+
+    auto cache = myFactory.getInstance<Cache>();
+    myFactory.onMemoryPressure(CppDiFactory::MemoryPressure::Critical);
+
+    CHECK(myFactory.getInstance<Cache>() == cache);
+}
+
+TEST_CASE( "MemoryPressure: only singletons can be retained", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    CHECK_THROWS(myFactory.registerClass<Cache>().retain());
+}
+
+TEST_CASE( "MemoryPressure: release unused pages of the long-lived region", "" ){
+
+    CppDiFactory::LongLivedRegion region(4 * 1024 * 1024, CppDiFactory::HugePages::Transparent);
+    region.allocate(100, 8);
+
+    CHECK(region.releaseSlack() > 0);
+    CHECK(region.allocate(100, 8) != nullptr);
+
+    // regular pages (the default) are released as well
+    CppDiFactory::LongLivedRegion regular(1024 * 1024);
+    char* used = static_cast<char*>(regular.allocate(100, 8));
+    used[99] = 1;
+    CHECK(regular.releaseSlack() > 0);
+    CHECK(used[99] == 1);
+}
+
+TEST_CASE( "MemoryPressure: watcher without pressure stall information", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    CHECK(!myFactory.watchMemoryPressure("/nonexistent/memory.pressure"));
+}
+
+} // namespace testCaseMemoryPressure
+
+#endif // TESTCASEMEMORYPRESSURE_H
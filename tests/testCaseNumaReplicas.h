@@ -0,0 +1,81 @@
+#ifndef TESTCASENUMAREPLICAS_H
+#define TESTCASENUMAREPLICAS_H
+
+#include <vector>
+
+#include "CppDiFactory.h"
+
+namespace testCaseNumaReplicas
+{
+
+class IRules
+{
+public:
+    virtual size_t count() const = 0;
+    virtual ~IRules() = default;
+};
+
+class Rules : public IRules
+{
+public:
+    Rules(size_t count): _rules(count, 1) {}
+
+    virtual size_t count() const override
+    {
+        return _rules.size();
+    }
+
+private:
+    std::vector<int> _rules;
+};
+
+class Unique
+{
+public:
+    Unique() = default;
+    Unique(const Unique&) = delete;
+};
+
+TEST_CASE( "NumaReplicas: parse sysfs lists", "" ){
+
+    using CppDiFactory::NumaTopology;
+
+    CHECK(NumaTopology::parseList("0") == std::vector<int>({ 0 }));
+    CHECK(NumaTopology::parseList("0-2,8,10-11") == std::vector<int>({ 0, 1, 2, 8, 10, 11 }));
+    CHECK(NumaTopology::parseList("").empty());
+}
+
+TEST_CASE( "NumaReplicas: replicated instance", "" ){
+
+    const CppDiFactory::NumaTopology& topology = CppDiFactory::NumaTopology::instance();
+    CHECK(topology.nodeCount() >= 1);
+    CHECK(topology.currentNode() < topology.nodeCount());
+    bool cachedNodesValid = true;
+    for (int i = 0; i < 3000; ++i){
+        cachedNodesValid = cachedNodesValid && topology.cachedCurrentNode() < topology.nodeCount();
+    }
+    CHECK(cachedNodesValid);
+
+    CppDiFactory::DiFactory myFactory;
+    auto rules = std::make_shared<Rules>(100);
+    myFactory.registerInstance(rules).replicatePerNumaNode().withInterfaces<IRules>();
+
+    auto local = myFactory.getInstance<IRules>();
+    CHECK(local->count() == 100);
+    if (topology.nodeCount() == 1){
+        CHECK(local == rules);
+    }
+    CHECK(local == myFactory.getInstance<IRules>());
+}
+
+TEST_CASE( "NumaReplicas: only copyable instances can be replicated", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+
+    CHECK_THROWS(myFactory.registerInstance(std::make_shared<Unique>()).replicatePerNumaNode());
+    CHECK_THROWS(myFactory.registerSingleton<Unique>().replicatePerNumaNode());
+}
+
+}
+
+#endif // TESTCASENUMAREPLICAS_H
@@ -0,0 +1,133 @@
+#ifndef TESTCASEREACHABILITY_H
+#define TESTCASEREACHABILITY_H
+
+#include <algorithm>
+
+#include "CppDiFactory.h"
+
+namespace testCaseReachability
+{
+
+class IScrew
+{
+public:
+    virtual ~IScrew() = default;
+};
+
+class IEngine
+{
+public:
+    virtual ~IEngine() = default;
+};
+
+class IWheels
+{
+public:
+    virtual ~IWheels() = default;
+};
+
+class Screw : public IScrew
+{
+};
+
+class Wheels : public IWheels
+{
+public:
+    Wheels(std::shared_ptr<IScrew>) {}
+};
+
+class Engine : public IEngine
+{
+public:
+    Engine(std::shared_ptr<IScrew>) {}
+};
+
+class Car
+{
+public:
+    Car(std::shared_ptr<IEngine>, std::shared_ptr<IWheels>) {}
+};
+
+bool contains(const std::vector<size_t>& ids, size_t id)
+{
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+TEST_CASE( "Reachability: transitive dependencies", "" ){
+
+    using CppDiFactory::type_id;
+
+    CppDiFactory::DiFactory myFactory;
+
+    myFactory.registerClass<Screw>().withInterfaces<IScrew>();
+    myFactory.registerSingleton<Engine, IScrew>().withInterfaces<IEngine>();
+    myFactory.registerClass<Wheels, IScrew>().withInterfaces<IWheels>();
+    myFactory.registerClass<Car, IEngine, IWheels>();
+
+    CHECK_NOTHROW(myFactory.validate());
+
+    CHECK((myFactory.dependsOn<Car, Screw>()));
+    CHECK((myFactory.dependsOn<Car, IEngine>()));
+    CHECK((myFactory.dependsOn<Engine, IScrew>()));
+    CHECK(!(myFactory.dependsOn<Engine, Wheels>()));
+    CHECK(!(myFactory.dependsOn<Screw, Car>()));
+
+    const std::vector<size_t> carDependencies = myFactory.transitiveDependencies<Car>();
+    CHECK(carDependencies.size() == 6);
+    CHECK(contains(carDependencies, type_id<Engine>()));
+    CHECK(!contains(carDependencies, type_id<Car>()));
+
+    const std::vector<size_t> screwDependents = myFactory.dependents<Screw>();
+    CHECK(screwDependents.size() == 6);
+    CHECK(contains(screwDependents, type_id<Wheels>()));
+    CHECK(contains(screwDependents, type_id<Car>()));
+    CHECK(myFactory.dependents<Car>().empty());
+}
+
+TEST_CASE( "Reachability: index is updated after registration changes", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+
+    myFactory.registerClass<Screw>().withInterfaces<IScrew>();
+    myFactory.registerClass<Engine, IScrew>().withInterfaces<IEngine>();
+
+    CHECK((myFactory.dependsOn<Engine, Screw>()));
+
+    myFactory.unregister<Screw>();
+
+    CHECK_THROWS((myFactory.dependsOn<Engine, Screw>()));
+}
+
+TEST_CASE( "Reachability: closure is computed per component on demand", "" ){
+
+    // 1 <- 2 <- 3 <- 4 (and 2 <- 4), 10 <- 11 (separate component)
+    std::vector<size_t> nodes = { 4, 3, 2, 1, 10, 11 };
+    std::vector<std::vector<size_t> > dependencies = { { 3, 2 }, { 2 }, { 1 }, {}, {}, { 10 } };
+
+    // dense and sparse (component above the limit) closures give the same answers
+    for (size_t denseLimit : { size_t(4096), size_t(2) }){
+        CppDiFactory::ReachabilityIndex index(denseLimit);
+        index.build(nodes, dependencies);
+        CHECK(index.closedComponents() == 0);
+
+        CHECK(index.dependsOn(4, 1));
+        CHECK(!index.dependsOn(1, 4));
+        CHECK(!index.dependsOn(4, 10));
+        CHECK(index.closedComponents() == 1);
+
+        std::vector<size_t> all = index.dependenciesOf(4);
+        std::sort(all.begin(), all.end());
+        CHECK((all == std::vector<size_t>{ 1, 2, 3 }));
+
+        std::vector<size_t> users = index.dependentsOf(2);
+        std::sort(users.begin(), users.end());
+        CHECK((users == std::vector<size_t>{ 3, 4 }));
+
+        CHECK(index.dependsOn(11, 10));
+        CHECK(index.closedComponents() == 2);
+    }
+}
+
+}
+
+#endif // TESTCASEREACHABILITY_H
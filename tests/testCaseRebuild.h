@@ -0,0 +1,214 @@
+#ifndef TESTCASEREBUILD_H
+#define TESTCASEREBUILD_H
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "CppDiFactory.h"
+
+namespace testCaseRebuild
+{
+
+class Config
+{
+public:
+    Config(const std::string& endpoint): _endpoint(endpoint) {}
+
+    std::string _endpoint;
+};
+
+class IClient
+{
+public:
+    virtual ~IClient() = default;
+    virtual std::string endpoint() const = 0;
+};
+
+class Client : public IClient
+{
+public:
+    Client(std::shared_ptr<Config> config): _config(config)
+    {
+        if (config->_endpoint.empty()){
+            throw std::runtime_error("no endpoint");
+        }
+    }
+
+    virtual std::string endpoint() const override { return _config->_endpoint; }
+
+    std::shared_ptr<Config> _config;
+};
+
+class Service
+{
+public:
+    Service(std::shared_ptr<IClient> client): _client(client) {}
+
+    std::shared_ptr<IClient> _client;
+};
+
+class Routes
+{
+public:
+    Routes(std::shared_ptr<Config> config): _config(config) {}
+
+    std::shared_ptr<Config> _config;
+};
+
+class Cache
+{
+};
+
+class Report
+{
+public:
+    Report(std::shared_ptr<Config> config): _config(config) {}
+
+    std::shared_ptr<Config> _config;
+};
+
+std::atomic<int> slowConstructions(0);
+
+/// constructed slowly, the rebuild has to wait for it even if another construction fails
+template <int Milliseconds>
+class Slow
+{
+public:
+    Slow(std::shared_ptr<Config>)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(Milliseconds));
+        ++slowConstructions;
+    }
+};
+
+/// runs each task on a thread of its own
+class ThreadPerTaskExecutor : public CppDiFactory::Executor
+{
+public:
+    virtual void execute(std::function<void()> task) override
+    {
+        std::thread(task).detach();
+    }
+};
+
+void registerTypes(CppDiFactory::DiFactory& factory)
+{
+    factory.registerInstance<Config>(std::make_shared<Config>("a"));
+    factory.registerSingleton<Client, Config>().withInterfaces<IClient>();
+    factory.registerSingleton<Service, IClient>();
+    factory.registerRefreshing<Routes, Config>(std::chrono::seconds(0));
+    factory.registerSingleton<Cache>();
+    factory.registerSingleton<Report, Config>();
+}
+
+TEST_CASE( "Rebuild: singletons depending on a changed registration are rebuilt", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    CHECK(myFactory.rebuildAffected() == 0);
+
+    std::shared_ptr<Service> service = myFactory.getInstance<Service>();
+    std::shared_ptr<Routes> routes = myFactory.getInstance<Routes>();
+    std::shared_ptr<Cache> cache = myFactory.getInstance<Cache>();
+
+    myFactory.registerInstance<Config>(std::make_shared<Config>("b"));
+
+    // nothing changes before the rebuild
+    CHECK(myFactory.getInstance<Service>() == service);
+    CHECK(myFactory.getInstance<Routes>() == routes);
+
+    // Client (needed by Service), Service and Routes
+    CHECK(myFactory.rebuildAffected() == 3);
+
+    std::shared_ptr<Service> rebuilt = myFactory.getInstance<Service>();
+    CHECK(rebuilt != service);
+    CHECK(rebuilt->_client->endpoint() == "b");
+    CHECK(rebuilt->_client == myFactory.getInstance<IClient>());
+    CHECK(myFactory.getInstance<Routes>()->_config->_endpoint == "b");
+
+    // the previous instances stay valid, unaffected ones are kept
+    CHECK(service->_client->endpoint() == "a");
+    CHECK(routes->_config->_endpoint == "a");
+    CHECK(myFactory.getInstance<Cache>() == cache);
+
+    // the changes are consumed
+    CHECK(myFactory.rebuildAffected() == 0);
+}
+
+TEST_CASE( "Rebuild: singletons which are not alive are created with the next request", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    CHECK(myFactory.getInstance<Report>()->_config->_endpoint == "a");
+
+    myFactory.registerInstance<Config>(std::make_shared<Config>("b"));
+    CHECK(myFactory.rebuildAffected() == 0);
+
+    CHECK(myFactory.getInstance<Report>()->_config->_endpoint == "b");
+}
+
+TEST_CASE( "Rebuild: a failed rebuild publishes nothing", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    std::shared_ptr<Service> service = myFactory.getInstance<Service>();
+    std::shared_ptr<Routes> routes = myFactory.getInstance<Routes>();
+
+    myFactory.registerInstance<Config>(std::make_shared<Config>(""));
+    CHECK_THROWS(myFactory.rebuildAffected());
+
+    CHECK(myFactory.getInstance<Service>() == service);
+    CHECK(myFactory.getInstance<Routes>() == routes);
+
+    // the changes stay pending
+    myFactory.registerInstance<Config>(std::make_shared<Config>("c"));
+    CHECK(myFactory.rebuildAffected() == 3);
+    CHECK(myFactory.getInstance<Service>()->_client->endpoint() == "c");
+}
+
+TEST_CASE( "Rebuild: a failed rebuild waits for the other constructions", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.setExecutor(std::make_shared<ThreadPerTaskExecutor>());
+    // slow constructions before and after the failing one (Client)
+    myFactory.registerSingleton<Slow<100>, Config>();
+    registerTypes(myFactory);
+    myFactory.registerSingleton<Slow<10>, Config>();
+
+    std::shared_ptr<Service> service = myFactory.getInstance<Service>();
+    std::shared_ptr<Slow<100> > slow100 = myFactory.getInstance<Slow<100> >();
+    std::shared_ptr<Slow<10> > slow10 = myFactory.getInstance<Slow<10> >();
+
+    myFactory.registerInstance<Config>(std::make_shared<Config>(""));
+    slowConstructions = 0;
+    CHECK_THROWS(myFactory.rebuildAffected());
+    // the constructions did not outlive the rebuild
+    CHECK(slowConstructions == 2);
+    CHECK((myFactory.getInstance<Slow<100> >() == slow100));
+}
+
+TEST_CASE( "Rebuild: re-registered singletons are rebuilt for their users", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    std::shared_ptr<Service> service = myFactory.getInstance<Service>();
+
+    myFactory.registerSingleton<Client, Config>().withInterfaces<IClient>();
+    CHECK(myFactory.rebuildAffected() == 2);
+
+    std::shared_ptr<Service> rebuilt = myFactory.getInstance<Service>();
+    CHECK(rebuilt != service);
+    CHECK(rebuilt->_client != service->_client);
+    CHECK(rebuilt->_client == myFactory.getInstance<IClient>());
+}
+
+} // namespace testCaseRebuild
+
+#endif // TESTCASEREBUILD_H
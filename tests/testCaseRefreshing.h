@@ -0,0 +1,150 @@
+#ifndef TESTCASEREFRESHING_H
+#define TESTCASEREFRESHING_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "CppDiFactory.h"
+
+namespace testCaseRefreshing
+{
+
+class IRoutingTable
+{
+public:
+    virtual int version() const = 0;
+    virtual ~IRoutingTable() = default;
+};
+
+class Source
+{
+public:
+    Source(): _version(0) {}
+
+    int next()
+    {
+        return ++_version;
+    }
+
+private:
+    std::atomic<int> _version;
+};
+
+class RoutingTable : public IRoutingTable
+{
+public:
+    RoutingTable(std::shared_ptr<Source> source):
+        _version(source->next())
+    {}
+
+    virtual int version() const override
+    {
+        return _version;
+    }
+
+private:
+    int _version;
+};
+
+class InlineExecutor : public CppDiFactory::Executor
+{
+public:
+    virtual void execute(std::function<void()> task) override
+    {
+        task();
+    }
+};
+
+class CountingExecutor : public CppDiFactory::Executor
+{
+public:
+    CountingExecutor(): executed(0) {}
+
+    virtual void execute(std::function<void()> task) override
+    {
+        ++executed;
+        task();
+    }
+
+    std::atomic<int> executed;
+};
+
+TEST_CASE( "Refreshing: instance is replaced on refresh", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerInstance(std::make_shared<Source>());
+    myFactory.registerRefreshing<RoutingTable, Source>(std::chrono::seconds(0)).withInterfaces<IRoutingTable>();
+
+    auto table1 = myFactory.getInstance<IRoutingTable>();
+    auto table2 = myFactory.getInstance<IRoutingTable>();
+    CHECK(table1 == table2);
+    CHECK(table1->version() == 1);
+
+    myFactory.refresh<IRoutingTable>();
+
+    auto table3 = myFactory.getInstance<IRoutingTable>();
+    CHECK(table3 != table1);
+    CHECK(table3->version() == 2);
+    // the previous instance is still valid for its users
+    CHECK(table1->version() == 1);
+}
+
+TEST_CASE( "Refreshing: instance is rebuilt periodically", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerInstance(std::make_shared<Source>());
+    myFactory.registerRefreshing<RoutingTable, Source>(std::chrono::milliseconds(5), std::make_shared<InlineExecutor>())
+             .withInterfaces<IRoutingTable>();
+
+    auto table = myFactory.getInstance<IRoutingTable>();
+    for (int i = 0; i < 400 && myFactory.getInstance<IRoutingTable>() == table; ++i){
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    CHECK(myFactory.getInstance<IRoutingTable>() != table);
+}
+
+TEST_CASE( "Refreshing: periodic refresh ends with the registration", "" ){
+
+    auto executor = std::make_shared<CountingExecutor>();
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerInstance(std::make_shared<Source>());
+    myFactory.registerRefreshing<RoutingTable, Source>(std::chrono::milliseconds(2), executor).withInterfaces<IRoutingTable>();
+
+    for (int i = 0; i < 400 && executor->executed == 0; ++i){
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(executor->executed > 0);
+
+    // replaced by a singleton, which must not be refreshed any longer
+    myFactory.registerSingleton<RoutingTable, Source>().withInterfaces<IRoutingTable>();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const int executed = executor->executed;
+    auto table = myFactory.getInstance<IRoutingTable>();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(executor->executed == executed);
+    CHECK(myFactory.getInstance<IRoutingTable>() == table);
+
+    // unregistered
+    myFactory.registerRefreshing<RoutingTable, Source>(std::chrono::milliseconds(2), executor).withInterfaces<IRoutingTable>();
+    myFactory.unregister<RoutingTable>();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const int executedAfterUnregister = executor->executed;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(executor->executed == executedAfterUnregister);
+}
+
+TEST_CASE( "Refreshing: refresh of other registrations is rejected", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerSingleton<Source>();
+
+    CHECK_THROWS(myFactory.refresh<Source>());
+}
+
+}
+
+#endif // TESTCASEREFRESHING_H
@@ -0,0 +1,128 @@
+#ifndef TESTCASEREQUESTSCOPE_H
+#define TESTCASEREQUESTSCOPE_H
+
+#include <string>
+#include <thread>
+
+#include "CppDiFactory.h"
+
+namespace testCaseRequestScope
+{
+
+class Tenant
+{
+public:
+    Tenant(const std::string& name): _name(name) {}
+
+    std::string _name;
+};
+
+class ISession
+{
+public:
+    virtual ~ISession() = default;
+};
+
+class Session : public ISession
+{
+public:
+    Session(std::shared_ptr<Tenant> tenant): _tenant(tenant) {}
+
+    std::shared_ptr<Tenant> _tenant;
+};
+
+class Handler
+{
+public:
+    Handler(std::shared_ptr<ISession> session): _session(session) {}
+
+    std::shared_ptr<ISession> _session;
+};
+
+void registerTypes(CppDiFactory::DiFactory& factory)
+{
+    factory.registerInstanceProvidedAtRequest<Tenant>();
+    factory.registerInstancePerRequest<Session, Tenant>().withInterfaces<ISession>();
+    factory.registerClass<Handler, ISession>();
+}
+
+TEST_CASE( "RequestScope: requests within a scope share their instances", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    auto tenant = std::make_shared<Tenant>("a");
+    CppDiFactory::RequestScope scope = myFactory.beginRequest(tenant);
+    CppDiFactory::RequestScope other = myFactory.beginRequest(std::make_shared<Tenant>("b"));
+    CHECK(scope);
+    CHECK(scope != other);
+
+    std::shared_ptr<ISession> session = myFactory.getInstance<ISession>(scope);
+    CHECK(std::static_pointer_cast<Session>(session)->_tenant == tenant);
+    CHECK(myFactory.getInstance<Handler>(scope)->_session == session);
+    CHECK(scope.getInstance<ISession>() == session);
+
+    CHECK(myFactory.getInstance<ISession>(other) != session);
+
+    // without a scope every request has its own instances
+    CHECK(myFactory.getInstance<Handler>(tenant)->_session != session);
+}
+
+TEST_CASE( "RequestScope: an active scope is used by all requests on the thread", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    CppDiFactory::RequestScope scope = myFactory.beginRequest(std::make_shared<Tenant>("a"));
+    std::shared_ptr<ISession> session = myFactory.getInstance<ISession>(scope);
+
+    CHECK(!CppDiFactory::RequestScope::current());
+    {
+        CppDiFactory::RequestScope::Activation activation(scope);
+        CHECK(CppDiFactory::RequestScope::current() == scope);
+
+        CHECK(myFactory.getInstance<Handler>()->_session == session);
+        CHECK(CppDiFactory::RequestScope::current().getInstance<ISession>() == session);
+        CHECK(myFactory.getInstanceAsync<Handler>().get()->_session == session);
+    }
+    CHECK(!CppDiFactory::RequestScope::current());
+    CHECK_THROWS(myFactory.getInstance<Handler>());
+}
+
+TEST_CASE( "RequestScope: a scope continues on another thread", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    CppDiFactory::RequestScope scope = myFactory.beginRequest(std::make_shared<Tenant>("a"));
+    std::shared_ptr<ISession> session = myFactory.getInstance<ISession>(scope);
+
+    std::shared_ptr<Handler> handler;
+    std::thread thread([&myFactory, &handler, scope]() {
+        CppDiFactory::RequestScope::Activation activation(scope);
+        handler = myFactory.getInstance<Handler>();
+    });
+    thread.join();
+
+    CHECK(handler->_session == session);
+}
+
+TEST_CASE( "RequestScope: scopes are bound to their factory", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    CppDiFactory::DiFactory otherFactory;
+    registerTypes(myFactory);
+    registerTypes(otherFactory);
+
+    CppDiFactory::RequestScope scope = otherFactory.beginRequest(std::make_shared<Tenant>("a"));
+    CHECK_THROWS(myFactory.getInstance<ISession>(scope));
+    CHECK_THROWS(myFactory.getInstance<ISession>(CppDiFactory::RequestScope()));
+
+    // a scope of another factory is not used by this factory
+    CppDiFactory::RequestScope::Activation activation(scope);
+    CHECK(myFactory.getInstance<ISession>(std::make_shared<Tenant>("b")) != otherFactory.getInstance<ISession>());
+}
+
+} // namespace testCaseRequestScope
+
+#endif // TESTCASEREQUESTSCOPE_H
@@ -0,0 +1,98 @@
+#ifndef TESTCASESTARTUPANALYSIS_H
+#define TESTCASESTARTUPANALYSIS_H
+
+#include <chrono>
+#include <thread>
+
+#include "CppDiFactory.h"
+
+namespace testCaseStartupAnalysis
+{
+
+void work(int milliseconds)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+class Config
+{
+public:
+    Config() { work(2); }
+};
+
+class IDatabase
+{
+public:
+    virtual ~IDatabase() = default;
+};
+
+class Database : public IDatabase
+{
+public:
+    Database(std::shared_ptr<Config>) { work(30); }
+};
+
+class Metrics
+{
+public:
+    Metrics(std::shared_ptr<Config>) { work(10); }
+};
+
+class Server
+{
+public:
+    Server(std::shared_ptr<IDatabase>, std::shared_ptr<Metrics>) { work(5); }
+};
+
+TEST_CASE( "StartupAnalysis: longest path", "" ){
+
+    using std::chrono::nanoseconds;
+
+    // 1 <- 2 <- 4, 1 <- 3 <- 4
+    const std::vector<size_t> order{ 1, 2, 3, 4 };
+    const std::vector<std::vector<size_t> > dependencies{ {}, { 1 }, { 1 }, { 2, 3 } };
+    const std::vector<nanoseconds> selfTime{ nanoseconds(1), nanoseconds(5), nanoseconds(7), nanoseconds(1) };
+
+    CHECK(CppDiFactory::longestPath(order, dependencies, selfTime) == std::vector<size_t>({ 1, 3, 4 }));
+}
+
+TEST_CASE( "StartupAnalysis: critical path of measured constructions", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerSingleton<Config>();
+    myFactory.registerSingleton<Database, Config>().withInterfaces<IDatabase>();
+    myFactory.registerSingleton<Metrics, Config>();
+    myFactory.registerSingleton<Server, IDatabase, Metrics>();
+    myFactory.enableConstructionTiming();
+
+    auto server = myFactory.getInstance<Server>();
+    const CppDiFactory::StartupReport report = myFactory.analyzeStartup();
+
+    REQUIRE(report.criticalPath.size() == 3);
+    CHECK(report.criticalPath[0].typeId == CppDiFactory::type_id<Config>());
+    CHECK(report.criticalPath[1].typeId == CppDiFactory::type_id<Database>());
+    CHECK(report.criticalPath[2].typeId == CppDiFactory::type_id<Server>());
+    CHECK(report.criticalPath[1].type == "testCaseStartupAnalysis::Database");
+
+    CHECK(report.types.size() == 4);
+    CHECK(report.types[0].typeId == CppDiFactory::type_id<Database>());
+    CHECK(report.totalTime > report.criticalPathTime);
+    CHECK(report.criticalPathTime >= std::chrono::milliseconds(37));
+    CHECK(report.parallelSpeedUp > 1.0);
+}
+
+TEST_CASE( "StartupAnalysis: timing disabled", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Config>();
+    myFactory.getInstance<Config>();
+
+    const CppDiFactory::StartupReport report = myFactory.analyzeStartup();
+    CHECK(report.types.empty());
+    CHECK(report.criticalPath.empty());
+    CHECK(report.parallelSpeedUp == 1.0);
+}
+
+} // namespace testCaseStartupAnalysis
+
+#endif // TESTCASESTARTUPANALYSIS_H
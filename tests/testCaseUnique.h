@@ -0,0 +1,186 @@
+#ifndef TESTCASEUNIQUE_H
+#define TESTCASEUNIQUE_H
+
+#include <atomic>
+#include <chrono>
+
+#include "CppDiFactory.h"
+
+namespace testCaseUnique
+{
+
+std::atomic<int> parserCount(0);
+
+class Config
+{
+};
+
+class IParser
+{
+public:
+    virtual ~IParser() = default;
+};
+
+class Parser : public IParser
+{
+public:
+    Parser(std::shared_ptr<Config> config): _config(config) { ++parserCount; }
+    virtual ~Parser() { --parserCount; }
+
+    std::shared_ptr<Config> _config;
+};
+
+class Handler
+{
+public:
+    Handler(std::unique_ptr<IParser> parser, std::shared_ptr<Config> config): _parser(std::move(parser)), _config(config) {}
+
+    std::unique_ptr<IParser> _parser;
+    std::shared_ptr<Config> _config;
+};
+
+class Dispatcher
+{
+public:
+    Dispatcher(std::unique_ptr<Handler> handler): _handler(std::move(handler)) {}
+
+    std::unique_ptr<Handler> _handler;
+};
+
+class IPlain
+{
+};
+
+class Plain : public IPlain
+{
+};
+
+class PlainUser
+{
+public:
+    PlainUser(std::unique_ptr<IPlain> plain): _plain(std::move(plain)) {}
+
+    std::unique_ptr<IPlain> _plain;
+};
+
+class SharedParserUser
+{
+public:
+    SharedParserUser(std::shared_ptr<Parser> parser): _parser(parser) {}
+
+    std::shared_ptr<Parser> _parser;
+};
+
+class Cache
+{
+public:
+    Cache(std::unique_ptr<Parser> parser): _parser(std::move(parser)) {}
+
+    std::unique_ptr<Parser> _parser;
+};
+
+void registerTypes(CppDiFactory::DiFactory& factory)
+{
+    factory.registerSingleton<Config>();
+    factory.registerClass<Parser, Config>().withInterfaces<IParser>();
+    factory.registerClass<Handler, CppDiFactory::Unique<IParser>, Config>();
+    factory.registerClass<Dispatcher, CppDiFactory::Unique<Handler> >();
+}
+
+TEST_CASE( "Unique: transient dependencies are injected as unique_ptr", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    parserCount = 0;
+    {
+        std::shared_ptr<Handler> first = myFactory.getInstance<Handler>();
+        std::shared_ptr<Handler> second = myFactory.getInstance<Handler>();
+        CHECK(parserCount == 2);
+        REQUIRE(first->_parser);
+        CHECK(first->_parser != second->_parser);
+        CHECK(dynamic_cast<Parser&>(*first->_parser)._config == first->_config);
+
+        std::shared_ptr<Dispatcher> dispatcher = myFactory.getInstance<Dispatcher>();
+        REQUIRE(dispatcher->_handler);
+        CHECK(dispatcher->_handler->_parser);
+        CHECK(parserCount == 3);
+    }
+    CHECK(parserCount == 0);
+
+    CHECK((myFactory.dependsOn<Dispatcher, Parser>()));
+}
+
+TEST_CASE( "Unique: only registerClass types can be exclusively owned", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerSingleton<Config>();
+    myFactory.registerSingleton<Parser, Config>().withInterfaces<IParser>();
+    myFactory.registerClass<Handler, CppDiFactory::Unique<IParser>, Config>();
+    CHECK_THROWS(myFactory.getInstance<Handler>());
+
+    myFactory.registerInstancePerRequest<Parser, Config>().withInterfaces<IParser>();
+    CHECK_THROWS(myFactory.getInstance<Handler>());
+
+    myFactory.registerInstance<Parser>(std::make_shared<Parser>(std::make_shared<Config>())).withInterfaces<IParser>();
+    CHECK_THROWS(myFactory.getInstance<Handler>());
+
+    myFactory.registerClass<Parser, Config>().withInterfaces<IParser>();
+    CHECK(myFactory.getInstance<Handler>());
+}
+
+TEST_CASE( "Unique: shared instances may own transient dependencies", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    myFactory.registerRefreshing<Cache, CppDiFactory::Unique<Parser> >(std::chrono::seconds(0));
+
+    std::shared_ptr<Cache> cache = myFactory.getInstance<Cache>();
+    REQUIRE(cache->_parser);
+
+    myFactory.refresh<Cache>();
+    std::shared_ptr<Cache> refreshed = myFactory.getInstance<Cache>();
+    CHECK(refreshed != cache);
+    REQUIRE(refreshed->_parser);
+    CHECK(refreshed->_parser != cache->_parser);
+}
+
+TEST_CASE( "Unique: exclusively owned dependencies constructed on an executor", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    myFactory.registerClass<Parser, Config>().withInterfaces<IParser>().constructOn(std::make_shared<CppDiFactory::WorkStealingExecutor>(1));
+    myFactory.registerClass<Handler, CppDiFactory::Unique<IParser>, Config>().constructOn(std::make_shared<CppDiFactory::WorkStealingExecutor>(1));
+
+    std::shared_ptr<Handler> handler = myFactory.getInstance<Handler>();
+    CHECK(handler->_parser);
+}
+
+TEST_CASE( "Unique: interfaces without virtual destructor can not be exclusively owned", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Plain>().withInterfaces<IPlain>();
+    myFactory.registerClass<PlainUser, CppDiFactory::Unique<IPlain> >();
+    CHECK_THROWS(myFactory.getInstance<PlainUser>());
+}
+
+TEST_CASE( "Unique: exclusive ownership is part of the registry fingerprint", "" ){
+
+    CppDiFactory::DiFactory shared;
+    shared.registerSingleton<Config>();
+    shared.registerSingleton<Parser, Config>();
+    shared.registerClass<SharedParserUser, Parser>();
+
+    CppDiFactory::DiFactory owned;
+    owned.registerSingleton<Config>();
+    owned.registerSingleton<Parser, Config>();
+    owned.registerClass<SharedParserUser, CppDiFactory::Unique<Parser> >();
+
+    CHECK(shared.registryFingerprint() != owned.registryFingerprint());
+    CHECK(shared.getInstance<SharedParserUser>());
+    CHECK_THROWS(owned.getInstance<SharedParserUser>());
+}
+
+} // namespace testCaseUnique
+
+#endif // TESTCASEUNIQUE_H
@@ -0,0 +1,134 @@
+#ifndef TESTCASEVALIDATIONCACHE_H
+#define TESTCASEVALIDATIONCACHE_H
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "CppDiFactory.h"
+
+namespace testCaseValidationCache
+{
+
+class IService
+{
+public:
+    virtual ~IService() = default;
+};
+
+class Service : public IService
+{
+};
+
+class Client
+{
+public:
+    Client(std::shared_ptr<IService> service): _service(service) {}
+
+    std::shared_ptr<IService> _service;
+};
+
+class Other
+{
+};
+
+void registerTypes(CppDiFactory::DiFactory& factory)
+{
+    factory.registerClass<Service>().withInterfaces<IService>();
+    factory.registerClass<Client, IService>();
+}
+
+size_t lineCount(const std::string& path)
+{
+    std::ifstream file(path.c_str());
+    std::string line;
+    size_t count = 0;
+    while (std::getline(file, line)){
+        ++count;
+    }
+    return count;
+}
+
+TEST_CASE( "ValidationCache: fingerprint", "" ){
+
+    CppDiFactory::DiFactory first;
+    CppDiFactory::DiFactory second;
+    registerTypes(first);
+    registerTypes(second);
+    CHECK(first.registryFingerprint() == second.registryFingerprint());
+
+    second.registerClass<Other>();
+    CHECK(first.registryFingerprint() != second.registryFingerprint());
+
+    // same types, other kind
+    CppDiFactory::DiFactory third;
+    third.registerSingleton<Service>().withInterfaces<IService>();
+    third.registerClass<Client, IService>();
+    CHECK(first.registryFingerprint() != third.registryFingerprint());
+
+    // same registrations in another order
+    CppDiFactory::DiFactory fourth;
+    fourth.registerClass<Client, IService>();
+    fourth.registerClass<Service>().withInterfaces<IService>();
+    CHECK(first.registryFingerprint() == fourth.registryFingerprint());
+
+    // registration changes after the fingerprint was computed
+    fourth.registerClass<Other>();
+    CHECK(fourth.registryFingerprint() == second.registryFingerprint());
+    fourth.unregister<Other>();
+    CHECK(first.registryFingerprint() == fourth.registryFingerprint());
+}
+
+TEST_CASE( "ValidationCache: results are stored and reused", "" ){
+
+    const std::string path = "validationCache.txt";
+    std::remove(path.c_str());
+
+    {
+        CppDiFactory::DiFactory myFactory;
+        registerTypes(myFactory);
+        myFactory.setValidationCache(path);
+        myFactory.validate();
+    }
+    // header and one line per type
+    CHECK(lineCount(path) == 4);
+
+    {
+        CppDiFactory::DiFactory myFactory;
+        registerTypes(myFactory);
+        myFactory.setValidationCache(path);
+        myFactory.validate();
+        CHECK(myFactory.getInstance<Client>()->_service);
+        // the reachability index is built on demand
+        CHECK((myFactory.dependsOn<Client, Service>()));
+    }
+
+    {
+        // changed registrations are validated again (and the cache is replaced)
+        CppDiFactory::DiFactory myFactory;
+        registerTypes(myFactory);
+        myFactory.registerClass<Other>();
+        myFactory.setValidationCache(path);
+        myFactory.validate();
+    }
+    CHECK(lineCount(path) == 5);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE( "ValidationCache: invalid registrations are not cached", "" ){
+
+    const std::string path = "validationCacheInvalid.txt";
+    std::remove(path.c_str());
+
+    CppDiFactory::DiFactory myFactory;
+    myFactory.registerClass<Client, IService>();
+    myFactory.setValidationCache(path);
+
+    CHECK_THROWS(myFactory.validate());
+    CHECK(!std::ifstream(path.c_str()).good());
+}
+
+} // namespace testCaseValidationCache
+
+#endif // TESTCASEVALIDATIONCACHE_H
@@ -0,0 +1,141 @@
+#ifndef TESTCASEWARMUP_H
+#define TESTCASEWARMUP_H
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+#include "CppDiFactory.h"
+
+namespace testCaseWarmUp
+{
+
+std::atomic<int> configCount(0);
+std::atomic<int> databaseCount(0);
+std::atomic<int> metricsCount(0);
+
+class Config
+{
+public:
+    Config() { ++configCount; }
+};
+
+class IDatabase
+{
+public:
+    virtual ~IDatabase() = default;
+};
+
+class Database : public IDatabase
+{
+public:
+    Database(std::shared_ptr<Config>) { ++databaseCount; }
+};
+
+class Metrics
+{
+public:
+    Metrics(std::shared_ptr<Config>) { ++metricsCount; }
+};
+
+class Handler
+{
+public:
+    Handler(std::shared_ptr<IDatabase> database): _database(database) {}
+
+    std::shared_ptr<IDatabase> _database;
+};
+
+class Unused
+{
+};
+
+class Broken
+{
+public:
+    Broken(std::shared_ptr<Config>) { throw new std::logic_error("broken"); }
+};
+
+void registerTypes(CppDiFactory::DiFactory& factory)
+{
+    factory.registerSingleton<Config>();
+    factory.registerSingleton<Database, Config>().withInterfaces<IDatabase>();
+    factory.registerSingleton<Metrics, Config>();
+    factory.registerClass<Handler, IDatabase>();
+    factory.registerSingleton<Unused>();
+}
+
+TEST_CASE( "WarmUp: warm up the types used by a previous run", "" ){
+
+    const std::string path = "usageProfile.txt";
+    std::remove(path.c_str());
+
+    {
+        CppDiFactory::DiFactory myFactory;
+        registerTypes(myFactory);
+        myFactory.recordUsage();
+        myFactory.getInstance<Handler>();
+        myFactory.recordUsage(false);
+        myFactory.getInstance<Metrics>();
+        CHECK(myFactory.saveUsageProfile(path));
+    }
+
+    configCount = 0;
+    databaseCount = 0;
+    metricsCount = 0;
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+
+    // Config and Database (used by Handler), but neither Metrics nor Unused
+    CHECK(myFactory.warmUp(path) == 2);
+    CHECK(configCount == 1);
+    CHECK(databaseCount == 1);
+    CHECK(metricsCount == 0);
+
+    // the warmed-up instances are used by the first request
+    auto handler = myFactory.getInstance<Handler>();
+    CHECK(handler->_database);
+    CHECK(configCount == 1);
+    CHECK(databaseCount == 1);
+
+    // nothing left to warm up
+    CHECK(myFactory.warmUp(path) == 0);
+
+    // warmed-up instances are released under memory pressure
+    handler.reset();
+    myFactory.onMemoryPressure(CppDiFactory::MemoryPressure::Moderate);
+    myFactory.getInstance<Handler>();
+    CHECK(databaseCount == 2);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE( "WarmUp: missing profile", "" ){
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    CHECK(myFactory.warmUp("doesNotExist.txt") == 0);
+}
+
+TEST_CASE( "WarmUp: failed constructions are reported", "" ){
+
+    const std::string path = "usageProfileBroken.txt";
+    CHECK(CppDiFactory::UsageProfile::store(path, { CppDiFactory::typeName(typeid(Broken)), CppDiFactory::typeName(typeid(Metrics)) }));
+
+    CppDiFactory::DiFactory myFactory;
+    registerTypes(myFactory);
+    myFactory.registerSingleton<Broken, Config>();
+
+    std::vector<std::string> failed;
+    // Config and Metrics
+    CHECK(myFactory.warmUp(path, &failed) == 2);
+    REQUIRE(failed.size() == 1);
+    CHECK(failed[0] == CppDiFactory::typeName(typeid(Broken)));
+
+    std::remove(path.c_str());
+}
+
+} // namespace testCaseWarmUp
+
+#endif // TESTCASEWARMUP_H